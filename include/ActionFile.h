@@ -0,0 +1,60 @@
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+   //                                                                                                //
+  //            Loads the actions from the config files, or from a binary file made from them        //
+ //                                                                                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ACTIONFILE_H_
+#define ACTIONFILE_H_
+
+#include <cstdint>                                                                                  // uint32_t, uint64_t
+#include <map>                                                                                      // std::map
+#include <string>                                                                                   // std::string
+#include <Utilities.h>                                                                              // JointTrajectory, CartesianMotion
+#include <yarp/os/Property.h>                                                                       // yarp::os::Property
+
+// Binary layout (version 1). Numbers are in the byte order of the machine that wrote the file, and
+// the header has a marker to catch a file from a machine with the other order:
+//
+//     ActionFileHeader
+//     ActionRecord[numActions]
+//     data: for each record, at its offset, numPoints times followed by numChannels arrays of
+//           numPoints values (one array per channel, so all the values of one channel are together)
+//
+// Joint actions have a channel per joint. Poses have 7 channels: x y z & the quaternion w x y z.
+// Every array starts on an 8 byte boundary, so the values can be read straight from the mapping.
+// load_action_file() copies them in to an ActionSet and unmaps the file again.
+
+struct ActionSet                                                                                    // Everything that can be performed by name
+{
+	std::map<std::string, JointTrajectory> joint;
+	std::map<std::string, CartesianMotion> left, right;                                         // Cartesian actions for each hand
+	std::map<std::string, CartesianMotion> grasp;                                               // For a grasped object
+};
+
+struct ActionFileHeader
+{
+	char     magic[8];                                                                          // "ICUBACT"
+	uint32_t version;
+	uint32_t byteOrder;                                                                         // 0x01020304 as written
+	uint32_t numActions;
+	uint32_t reserved;
+};
+
+struct ActionRecord
+{
+	char     name[48];                                                                          // Null terminated
+	uint32_t group;                                                                             // 0 joint, 1 left, 2 right, 3 grasp
+	uint32_t type;                                                                              // relative or absolute
+	uint32_t numPoints;
+	uint32_t numChannels;
+	uint64_t offset;                                                                            // From the start of the file to the times
+};
+
+bool load_actions(const yarp::os::Property &parameter, ActionSet &actions);                         // From the groups in the config files
+
+bool load_action_file(const std::string &path, ActionSet &actions);                                 // From a binary file
+
+bool save_action_file(const std::string &path, const ActionSet &actions);                           // Convert to a binary file
+
+#endif
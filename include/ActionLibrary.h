@@ -0,0 +1,64 @@
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+   //                                                                                                //
+  //                Actions from the config files, with their splines solved in advance             //
+ //                                                                                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ACTIONLIBRARY_H_
+#define ACTIONLIBRARY_H_
+
+#include <iostream>                                                                                 // std::cerr
+#include <MultiSpline.h>                                                                            // Compiled trajectories
+#include <string>                                                                                   // std::string
+#include <unordered_map>                                                                            // std::unordered_map
+#include <vector>                                                                                   // std::vector
+
+// Absolute actions are solved once at start up with a placeholder for the start, so performing one
+// is a hash look-up and a copy of a shared pointer: MultiSpline::set_start() moves the start to
+// wherever the robot is without solving the spline again. Relative actions depend on the pose at
+// the time they are called, so they are still built on demand.
+
+struct CompiledAction
+{
+	MultiSpline first;                                                                          // Joints, left hand, or grasped object
+	MultiSpline second;                                                                         // Right hand (Cartesian actions only)
+};
+
+class ActionLibrary
+{
+	public:
+		ActionLibrary() {}                                                                  // Empty constructor
+
+		bool add(const std::string &name, const CompiledAction &action)                     // False if the name is taken
+		{
+			if(not this->index.emplace(name, this->actions.size()).second)
+			{
+				std::cerr << "[ERROR] [ACTION LIBRARY] add(): "
+				          << "There is already an action called '" << name << "'.\n";
+
+				return false;
+			}
+
+			this->actions.push_back(action);
+
+			return true;
+		}
+
+		const CompiledAction* find(const std::string &name) const                           // nullptr if there isn't one
+		{
+			auto entry = this->index.find(name);
+
+			return entry == this->index.end() ? nullptr : &this->actions[entry->second];
+		}
+
+		unsigned int size() const { return this->actions.size(); }
+
+	private:
+
+		std::vector<CompiledAction> actions;                                                // Stored together, in the order added
+
+		std::unordered_map<std::string, unsigned int> index;                                // Name -> position in actions
+
+};                                                                                                  // Semicolon needed after class declaration
+
+#endif
@@ -0,0 +1,31 @@
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+   //                                                                                                //
+  //            Catches heap allocations in real-time code (builds with CHECK_ALLOCATIONS)           //
+ //                                                                                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ALLOCATIONTRACKER_H_
+#define ALLOCATIONTRACKER_H_
+
+// With -DCHECK_ALLOCATIONS=ON, malloc() & friends are replaced so they count every call made by a
+// thread between begin_allocation_check() and end_allocation_check(). If there were any, the
+// program prints where and aborts. Otherwise these functions do nothing and cost nothing.
+//
+// Eigen's EIGEN_RUNTIME_NO_MALLOC isn't used because its flag is shared by every thread, so it
+// would also trip on the command thread building trajectories while the control thread runs.
+
+#ifdef CHECK_ALLOCATIONS
+
+void begin_allocation_check();                                                                      // Start counting for this thread
+
+void end_allocation_check(const char *where);                                                       // Stop counting, abort if non-zero
+
+#else
+
+inline void begin_allocation_check() {}
+
+inline void end_allocation_check(const char *) {}
+
+#endif
+
+#endif
@@ -8,8 +8,8 @@
 #define CARTESIAN_TRAJECTORY_H_
 
 #include <Eigen/Geometry>                                                                           // Eigen::Isometry3d
-#include <iDynTree/Core/CubicSpline.h>                                                              // Fundamental trajectory object
 #include <iostream>                                                                                 // std::cout, std::cerr
+#include <MultiSpline.h>                                                                            // Fundamental trajectory object
 #include <vector>                                                                                   // std::vector
 
 class CartesianTrajectory
@@ -27,6 +27,22 @@ class CartesianTrajectory
 		CartesianTrajectory(const std::vector<Eigen::Isometry3d> &poses,
 		                    const std::vector<double>            &times,
 		                    const Eigen::Matrix<double,6,1>      &startVelocity);
+
+		// Start a trajectory made by compile() from the given pose & velocity, with no acceleration
+		CartesianTrajectory(const MultiSpline                    &compiled,
+		                    const Eigen::Isometry3d              &startPose,
+		                    const Eigen::Matrix<double,6,1>      &startVelocity)
+		:
+		CartesianTrajectory(compiled,startPose,startVelocity,Eigen::Matrix<double,6,1>::Zero()) {}
+
+		// Start a trajectory made by compile() from the given pose, velocity & acceleration
+		CartesianTrajectory(const MultiSpline                    &compiled,
+		                    const Eigen::Isometry3d              &startPose,
+		                    const Eigen::Matrix<double,6,1>      &startVelocity,
+		                    const Eigen::Matrix<double,6,1>      &startAcceleration);
+
+		static MultiSpline compile(const std::vector<Eigen::Isometry3d> &poses,
+		                           const std::vector<double>            &times);        // Solve now, start from anywhere later
 		                    
 		Eigen::Isometry3d get_pose(const double &time);
 		            
@@ -34,12 +50,21 @@ class CartesianTrajectory
 		               Eigen::Matrix<double,6,1> &twist,
 		               Eigen::Matrix<double,6,1> &acc,
 		               const double              &time);                                    // Get the desired state for the given time
+
+		bool sample(const std::vector<double>      &times,
+		            std::vector<Eigen::Isometry3d> &poses,
+		            Eigen::Ref<Eigen::MatrixXd>    twists,
+		            Eigen::Ref<Eigen::MatrixXd>    accelerations) const;                    // Whole trajectory; 6xN outputs, N poses
 	
 	private:
 	
 		int numPoses;                                                                       // Number of poses
 		
-		std::vector<iDynTree::CubicSpline> spline;                                          // Array of spline objects
+		MultiSpline spline;                                                                 // x y z & angle*axis together
+
+		static Eigen::Matrix<double,6,1> pose_vector(const Eigen::Isometry3d &pose);        // Position & angle*axis
+
+		static Eigen::Isometry3d vector_pose(const Eigen::Ref<const Eigen::Matrix<double,6,1>> &point); // And back again
 		
 };                                                                                                  // Semicolon needed after class declaration
 
@@ -0,0 +1,120 @@
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+   //                                                                                                //
+  //               Measures how long each stage of the control loop takes, and the jitter           //
+ //                                                                                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LOOPTIMER_H_
+#define LOOPTIMER_H_
+
+#include <algorithm>                                                                                // std::min, std::max
+#include <array>                                                                                    // std::array
+#include <atomic>                                                                                   // std::atomic
+#include <chrono>                                                                                   // std::chrono::steady_clock
+#include <cmath>                                                                                    // std::log2, std::pow
+#include <sstream>                                                                                  // std::stringstream
+#include <string>                                                                                   // std::string
+#include <yarp/os/Bottle.h>                                                                         // yarp::os::Bottle
+#include <yarp/os/BufferedPort.h>                                                                   // yarp::os::BufferedPort
+#include <yarp/os/PeriodicThread.h>                                                                 // yarp::os::PeriodicThread
+
+// Bins are spaced logarithmically from 1 microsecond to about 1 second (4 per octave). The control
+// thread records and any other thread can read; counts are atomic so nothing ever locks.
+class TimingHistogram
+{
+	public:
+		TimingHistogram() { reset(); }
+
+		void record(const double &seconds);                                                 // Add a sample
+
+		void reset();                                                                       // Clear all the samples
+
+		double percentile(const double &fraction) const;                                    // e.g. 0.99 for the 99th percentile
+
+		double max() const { return this->maxNanoseconds.load(std::memory_order_relaxed)*1e-9; }
+
+		unsigned long count() const { return this->samples.load(std::memory_order_relaxed); }
+
+	private:
+
+		static constexpr int numBins = 81;                                                  // 1 + 4 bins/octave * 20 octaves
+
+		std::array<std::atomic<unsigned long>, numBins> bins;
+
+		std::atomic<unsigned long> samples{0};
+
+		std::atomic<unsigned long> maxNanoseconds{0};
+
+		static double upper_edge(const int &bin) { return 1e-6*std::pow(2.0, bin/4.0); }
+
+};                                                                                                  // Semicolon needed after class declaration
+
+class LoopTimer
+{
+	public:
+		enum Stage {state, reference, solve, command, total, numStages};                    // total is start to end of the tick
+
+		LoopTimer() {}                                                                      // Empty constructor
+
+		void restart() { this->lastTickStart = TimePoint(); }                               // Don't measure jitter across a stop()/start()
+
+		void start_tick();                                                                  // Call at the start of run()
+
+		void end_stage(const Stage &stage);                                                 // Time since start_tick() or the last end_stage()
+
+		void end_tick(const double &period);                                                // Records the total & checks for an overrun
+
+		void reset();                                                                       // Clear all the histograms
+
+		const TimingHistogram& stage(const Stage &stage) const { return this->stages[stage]; }
+
+		const TimingHistogram& jitter() const { return this->jitterHistogram; }
+
+		unsigned long overruns() const { return this->overrunCount.load(std::memory_order_relaxed); }
+
+		std::string report() const;                                                         // Table for printing
+
+		void write(yarp::os::Bottle &bottle) const;                                         // For publishing over YARP
+
+		static std::string stage_name(const Stage &stage);
+
+	private:
+
+		using TimePoint = std::chrono::steady_clock::time_point;                            // Real time, even when simulating faster
+
+		TimePoint tickStart, lastMark, lastTickStart;
+
+		double interval = -1;                                                               // Time between the last 2 ticks
+
+		std::array<TimingHistogram, numStages> stages;
+
+		TimingHistogram jitterHistogram;                                                    // |actual period - desired period|
+
+		std::atomic<unsigned long> overrunCount{0};                                         // Ticks that took longer than the period
+
+};                                                                                                  // Semicolon needed after class declaration
+
+// Publishes the loop statistics on a port at a low rate, so it never slows the control loop
+class TimingPublisher : public yarp::os::PeriodicThread
+{
+	public:
+		TimingPublisher(const LoopTimer *_timer, const double &period = 1.0)
+		:
+		yarp::os::PeriodicThread(period),
+		timer(_timer) {}
+
+		bool open(const std::string &portName) { return this->port.open(portName); }
+
+		void run();
+
+		void threadRelease() { this->port.close(); }
+
+	private:
+
+		const LoopTimer *timer;
+
+		yarp::os::BufferedPort<yarp::os::Bottle> port;
+
+};                                                                                                  // Semicolon needed after class declaration
+
+#endif
@@ -0,0 +1,138 @@
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+   //                                                                                                //
+  //         A cubic spline with many channels that all share the same knots (waypoint times)       //
+ //                                                                                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MULTISPLINE_H_
+#define MULTISPLINE_H_
+
+#include <algorithm>                                                                                // std::upper_bound
+#include <cmath>                                                                                    // std::abs, sqrt
+#include <Eigen/Core>                                                                               // Eigen::MatrixXd, Eigen::Ref
+#include <iostream>                                                                                 // std::cerr
+#include <memory>                                                                                   // std::shared_ptr
+#include <stdexcept>                                                                                // std::invalid_argument, std::runtime_error
+#include <string>                                                                                   // std::to_string
+#include <vector>                                                                                   // std::vector
+
+// Every channel (x y z rx ry rz for a pose, or every joint) passes through its waypoints at the
+// same times, with the velocity & acceleration set at the start, zero velocity at the end, and
+// continuous acceleration in between. Since the knots are shared the tridiagonal system is
+// factorised once for all the channels, and evaluating needs one segment search for all of them.
+//
+// The first segment is a quartic so there is a coefficient free to match the start acceleration;
+// that lets a new trajectory carry on from one that is running without a jump in acceleration.
+// The rest are cubic. The coefficients are stored channel-wise: column k of c0 ... c4 holds the
+// polynomial of segment k for every channel (c4 is zero after the first segment), so a whole
+// column is evaluated in one vectorised pass:
+//
+//     p(t) = c0 + c1*dt + c2*dt^2 + c3*dt^3 + c4*dt^4,     dt = t - t_k
+//
+// The control loop asks for times that only ever increase, so the last segment is remembered and
+// the search starts from there: usually it is the same segment, or the next one. Going backwards
+// falls back to a binary search. Because of this, one spline shouldn't be evaluated by two threads
+// at once (each thread should have its own copy, as the control plans do).
+//
+// The spline is linear in its start point, velocity & acceleration, so they can be changed after it
+// is built with set_start(): the solution for a unit change in each is kept, scaled and added on.
+// That lets an action be solved once and started from wherever the robot happens to be. The
+// coefficients never change after construction, so copies share them rather than duplicating.
+//
+// sample() fills a column for each of many times, e.g. to check or plot a whole trajectory. All
+// the times in one segment are evaluated together as [c0 ... c4]*[1; dt; ... ; dt^4], with one
+// column of powers per time. It keeps its own place instead of the cursor, so it is safe to call
+// from another thread while the control thread evaluates the same spline.
+
+class MultiSpline
+{
+	public:
+		MultiSpline() {}                                                                    // Empty constructor
+
+		// Delegating constructor, starting at rest
+		MultiSpline(const Eigen::MatrixXd     &points,
+		            const std::vector<double> &times)
+		:
+		MultiSpline(points,times,Eigen::VectorXd::Zero(points.rows())) {}
+
+		// Delegating constructor, starting with no acceleration
+		MultiSpline(const Eigen::MatrixXd     &points,
+		            const std::vector<double> &times,
+		            const Eigen::VectorXd     &startVelocity)
+		:
+		MultiSpline(points,times,startVelocity,Eigen::VectorXd::Zero(points.rows())) {}
+
+		// Full constructor; one column of points for each time
+		MultiSpline(const Eigen::MatrixXd     &points,
+		            const std::vector<double> &times,
+		            const Eigen::VectorXd     &startVelocity,
+		            const Eigen::VectorXd     &startAcceleration);
+
+		bool evaluate(const double &time, Eigen::Ref<Eigen::VectorXd> pos) const;           // Position only
+
+		bool evaluate(const double                &time,
+		              Eigen::Ref<Eigen::VectorXd> pos,
+		              Eigen::Ref<Eigen::VectorXd> vel,
+		              Eigen::Ref<Eigen::VectorXd> acc) const;                               // Position, velocity & acceleration
+
+		bool sample(const std::vector<double>   &times,
+		            Eigen::Ref<Eigen::MatrixXd> pos,
+		            Eigen::Ref<Eigen::MatrixXd> vel,
+		            Eigen::Ref<Eigen::MatrixXd> acc) const;                                 // Column per time, all at once
+
+		static std::vector<double> fastest_times(const Eigen::MatrixXd &points,
+		                                         const Eigen::VectorXd &startVelocity,
+		                                         const Eigen::VectorXd &maxVelocity,
+		                                         const Eigen::VectorXd &maxAcceleration); // Quickest times within the limits
+
+		bool set_start(const Eigen::VectorXd &point, const Eigen::VectorXd &velocity);      // Move the first waypoint
+
+		bool set_start(const Eigen::VectorXd &point,
+		               const Eigen::VectorXd &velocity,
+		               const Eigen::VectorXd &acceleration);                                // And change the start acceleration
+
+		Eigen::MatrixXd waypoints() const;                                                  // One column per knot
+
+		unsigned int dimensions() const { return this->data ? this->data->c0.rows() : 0; }
+
+		unsigned int num_points() const { return this->data ? this->data->times.size() : 0; }
+
+		double start_time() const { return this->data ? this->data->times.front() : 0.0; }
+
+		double end_time() const { return this->data ? this->data->times.back() : 0.0; }
+
+	private:
+
+		static constexpr double minimumDuration    = 0.05;                                  // For segments that barely move (s)
+		static constexpr int maxRetimingIterations = 100;                                   // Throw if still outside the limits after this many
+
+		struct Coefficients
+		{
+			std::vector<double> times;                                                  // Knots
+
+			Eigen::MatrixXd c0, c1, c2, c3, c4;                                         // Row per channel, column per segment
+
+			Eigen::Matrix<double,5,Eigen::Dynamic> pointBasis;                          // Unit change in the start point, column per segment
+			Eigen::Matrix<double,5,Eigen::Dynamic> velocityBasis;                       // Unit change in the start velocity
+			Eigen::Matrix<double,5,Eigen::Dynamic> accelerationBasis;                   // Unit change in the start acceleration
+
+			Eigen::VectorXd startPoint, startVelocity, startAcceleration;               // What it was built with
+
+			Eigen::VectorXd endPoint;                                                   // Held after the last knot
+		};
+
+		std::shared_ptr<const Coefficients> data;                                           // Shared by copies
+
+		Eigen::VectorXd pointShift, velocityShift, accelerationShift;                       // Added by set_start(); empty if not used
+
+		mutable unsigned int cursor = 0;                                                    // Segment found last time
+
+		unsigned int segment(const double &time) const;                                     // Find where the time falls
+
+		void peak_rates(const unsigned int &k,
+		                Eigen::VectorXd &velocity,
+		                Eigen::VectorXd &acceleration) const;                               // Largest magnitudes over segment k
+
+};                                                                                                  // Semicolon needed after class declaration
+
+#endif
@@ -7,117 +7,72 @@
 #ifndef POSITION_CONTROL_H_
 #define POSITION_CONTROL_H_
 
+#include <AllocationTracker.h>                                                                      // Checks run() in CHECK_ALLOCATIONS builds
 #include <iCubBase.h>
 
 class PositionControl : public iCubBase
 {
 	public:
 		PositionControl(const std::string              &pathToURDF,
-			        const std::vector<std::string> &jointNames,
-			        const std::vector<std::string> &portNames,
-			        const Eigen::Isometry3d        &_torsoPose,
-			        const std::string              &robotName) :
-	        iCubBase(pathToURDF, jointNames, portNames, _torsoPose, robotName) {}
-		
-		// Inherited from the iCubBase class   
-		void compute_joint_limits(double &lower, double &upper, const int &i);
-			              
+		                const std::vector<std::string> &jointList,
+		                const std::vector<std::string> &portList,
+		                const std::string              &robotModel,
+		                const JointInterface::Backend  &backend    = JointInterface::Backend::yarp,
+		                const SimulationParameters     &simulation = SimulationParameters());
+
+		// Inherited from the iCubBase class
+		bool compute_joint_limits(double &lower, double &upper, const unsigned int &jointNum);
+
 		Eigen::Matrix<double,12,1> track_cartesian_trajectory(const double &time);
-		
-		Eigen::VectorXd track_joint_trajectory(const double &time);
-		
+
+		bool enable_preflight(const bool &active) override;                                 // Adds the shoulder constraints for the iCub2
+
 		// Inherited from the yarp::PeriodicThread class
 		bool threadInit();
+		void run();
 		void threadRelease();
-		
+
 	protected:
+
 		Eigen::VectorXd qRef;                                                               // Reference joint position to send to motors
-		
-};                                                                                                  // Semicolon needed after class declaration
 
+		unsigned int ticks = 0;                                                             // Control steps since start()
+		static constexpr unsigned int warmUpTicks = 10;                                     // Allocations are allowed before this
 
-  ////////////////////////////////////////////////////////////////////////////////////////////////////
- //                             Compute instantenous position limits                               //
-////////////////////////////////////////////////////////////////////////////////////////////////////
-void PositionControl::compute_joint_limits(double &lower, double &upper, const int &i)
-{
-	lower = this->pLim[i][0] - this->qRef[i];
-	upper = this->pLim[i][1] - this->qRef[i];
-}
+		// Storage for each control step, sized in the constructor so run() doesn't allocate
+		Eigen::VectorXd dq;                                                                 // Joint step to solve for
+		Eigen::VectorXd jointReference;                                                     // From the joint trajectory
+		Eigen::VectorXd lowerBound, upperBound;                                             // Instantaneous limits on dq
+		Eigen::VectorXd redundantTask;                                                      // Secondary task in Cartesian control
+		Eigen::VectorXd startPoint;                                                         // Initial guess for the QP solver
+		Eigen::VectorXd z;                                                                  // Constraint vector for the iCub2
+		Eigen::MatrixXd Jc;                                                                 // Constraint Jacobian when grasping
+		Eigen::MatrixXd JinvM;                                                              // J*M^-1 for the Lagrange multipliers
 
+		// QP problems for the iCub2: min 0.5*x'*H*x + x'*f subject to B*x >= z
+		Eigen::MatrixXd jointH, cartesianH, graspH;
+		Eigen::VectorXd jointF, cartesianF, graspF;
+		Eigen::VectorXd cartesianStart, graspStart;                                         // Includes Lagrange multipliers
 
-  ////////////////////////////////////////////////////////////////////////////////////////////////////
- //                                 Initialise the control thread                                  //
-////////////////////////////////////////////////////////////////////////////////////////////////////
-bool PositionControl::threadInit()
-{
-	this->isFinished = false;                                                                   
-	this->qRef = this->q;                                                                       // Use current joint configuration as reference point
-	this->startTime = yarp::os::Time::now();
-	return true;
-	// jump immediately to run();
-}
-
-  ////////////////////////////////////////////////////////////////////////////////////////////////////
- //                             Executed after a control thread is stopped                         //
-////////////////////////////////////////////////////////////////////////////////////////////////////
-void PositionControl::threadRelease()
-{
-	for(int i = 0; i < this->n; i++) send_joint_command(i,this->q[i]);                          // Maintain current joint position
-}
+		// Shoulder constraints for the iCub2: A*q + b >= 0
+		Eigen::MatrixXd A;
+		Eigen::Matrix<double,10,1> b;
 
-  ////////////////////////////////////////////////////////////////////////////////////////////////////
- //                        Solve a discrete time step for Cartesian control                        //
-////////////////////////////////////////////////////////////////////////////////////////////////////
-Eigen::Matrix<double,12,1> PositionControl::track_cartesian_trajectory(const double &time)
-{
-	// Variables used in this scope
-	Eigen::Matrix<double,12,1> dx; dx.setZero();                                                // Value to be returned
-	Eigen::Isometry3d pose;                                                                     // Desired pose
-	Eigen::Matrix<double,6,1> vel, acc;
-	double gain = 0.005;
-	
-/*	if(this->isGrasping)
-	{
-		this->payloadTrajectory.get_state(pose,vel,acc,time);
-
-		dx = this->G.transpose()*( this->dt*vel + gain*pose_error(pose,this->payload.pose()) );
-	}
-	else
-	{*/
-		if(this->leftControl)
-		{
-			this->leftTrajectory.get_state(pose,vel,acc,time);
-
-			dx.head(6) = this->dt*vel + gain*pose_error(pose,this->leftPose);
-		}
-
-		if(this->rightControl)
-		{
-			this->rightTrajectory.get_state(pose,vel,acc,time);
-
-			dx.tail(6) = this->dt*vel + gain*pose_error(pose,this->rightPose);
-		}
-//	}
-	
-	return dx;
-}
-
-  ////////////////////////////////////////////////////////////////////////////////////////////////////
- //                     Solve the step size to track the joint trajectory                          //
-////////////////////////////////////////////////////////////////////////////////////////////////////
-Eigen::VectorXd PositionControl::track_joint_trajectory(const double &time)
-{
-	Eigen::VectorXd dq(this->n); dq.setZero();                                                  // Value to be returned
-	
-	for(int i = 0; i < this->n; i++)
-	{
-		dq[i] = this->jointTrajectory[i].evaluatePoint(time) - this->q[i];                  
-		
-//		dq[i] = this->jointTrajectory[i].evaluatePoint(time) - this->qHat[i];
-	}
-	
-	return dq;
-}
+		// Constraint matrices for the QP solver
+		Eigen::MatrixXd B;                                                                  // Includes columns for Lagrange multipliers
+		Eigen::MatrixXd Bsmall;                                                             // Joint control only
+
+		Eigen::Matrix<double,6,1> grasp_correction();                                       // Fake force to keep the hands on the object
+
+		void icub2_cartesian_control(const Eigen::Matrix<double,12,1> &dx,                  // Solution is put in dq
+		                             const Eigen::VectorXd &redundantTask,
+		                             const Eigen::VectorXd &lowerBound,
+		                             const Eigen::VectorXd &upperBound,
+		                             Eigen::VectorXd &dq);
+
+		Eigen::Matrix<double,12,1> lagrange_multipliers(const Eigen::Matrix<double,12,1> &dx,
+		                                                const Eigen::VectorXd &redundantTask);
+
+};                                                                                                  // Semicolon needed after class declaration
 
 #endif
@@ -0,0 +1,99 @@
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+   //                                                                                                //
+  //         Rehearses an action on a copy of the kinematics before the robot is asked to do it     //
+ //                                                                                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PREFLIGHT_H_
+#define PREFLIGHT_H_
+
+#include <array>                                                                                    // std::array
+#include <CartesianTrajectory.h>                                                                    // Hand trajectories
+#include <Eigen/Dense>                                                                              // Eigen::MatrixXd, Eigen::VectorXd
+#include <iDynTree/Core/EigenHelpers.h>                                                             // Converts iDynTree tensors to Eigen
+#include <iDynTree/KinDynComputations.h>                                                            // Its own copy of the kinematics
+#include <iDynTree/Model/Model.h>                                                                   // iDynTree::Model
+#include <MultiSpline.h>                                                                            // Joint trajectories
+#include <mutex>                                                                                    // std::mutex
+#include <QPSolver.h>                                                                               // Same solver as the control loop
+#include <string>                                                                                   // std::string
+#include <vector>                                                                                   // std::vector
+
+// The control thread only finds out that an action can't be done while it is doing it. This steps
+// through the action ahead of time, as fast as it can be computed, in the thread that asked for
+// it. Joint trajectories are checked against the position & velocity limits (and the shoulder
+// constraints of the iCub2). Cartesian trajectories are rolled out through the same resolved-rate
+// step as the control loop: feedforward + feedback on the hand poses, solved with the joint limits
+// by QPSolver::redundant_least_squares(), or with the joint constraints as well when they are set,
+// like icub2_cartesian_control(). The motors are assumed to follow exactly. The first problem
+// found is described in the diagnosis.
+
+class PreFlight : public QPSolver
+{
+	public:
+		PreFlight(const iDynTree::Model                    &model,                          // With the "left" & "right" hand frames
+		          const iDynTree::Transform                &basePose,
+		          const std::vector<std::array<double,2>>  &positionLimit,
+		          const std::vector<double>                &velocityLimit);
+
+		void set_constraints(const Eigen::MatrixXd &A, const Eigen::VectorXd &b);           // Also require A*q + b >= 0
+
+		bool check_joint_motion(const MultiSpline &trajectory,
+		                        const double      &dt,
+		                        std::string       &diagnosis);                              // False if the limits would be broken
+
+		bool check_cartesian_motion(const Eigen::VectorXd           &startPosition,
+		                            const CartesianTrajectory       &left,
+		                            const CartesianTrajectory       &right,
+		                            const double                    &duration,
+		                            const Eigen::VectorXd           &desiredPosition,       // For the redundant task
+		                            const Eigen::Matrix<double,6,6> &K,                     // Feedback on pose error (1/s)
+		                            const double                    &threshold,             // Manipulability
+		                            const double                    &dt,
+		                            std::string                     &diagnosis);            // False if the hands can't follow
+
+	private:
+
+		static constexpr double positionTolerance    = 0.01;                                // Final hand position error (m)
+		static constexpr double orientationTolerance = 0.05;                                // Final hand orientation error
+		static constexpr double limitMargin          = 1e-3;                                // Joint counts as being at its limit (rad)
+
+		std::mutex mutex;                                                                   // One check at a time
+
+		unsigned int numJoints;
+
+		std::vector<std::array<double,2>> positionLimit;
+
+		std::vector<double> velocityLimit;
+
+		Eigen::MatrixXd A;                                                                  // A*q + b >= 0, if set
+		Eigen::VectorXd b;
+		Eigen::MatrixXd constraintMatrix;                                                   // B*x >= z for the Cartesian step with A
+
+		iDynTree::KinDynComputations computer;
+		iDynTree::Transform          basePose;
+		iDynTree::Vector3            gravity;
+
+		Eigen::MatrixXd jacobianBuffer, massBuffer;
+		iDynTree::VectorDynSize jointPositionBuffer, jointVelocityBuffer;
+
+		std::string joint_name(const unsigned int &i) const;
+
+		std::string joints_at_limits(const Eigen::VectorXd &q) const;                       // For the diagnosis
+
+		bool check_constraints(const Eigen::VectorXd &q, const double &time, std::string &diagnosis) const;
+
+		void solve_constrained(const Eigen::Matrix<double,12,1> &dx,
+		                       const Eigen::VectorXd            &redundantTask,
+		                       const Eigen::MatrixXd            &J,
+		                       const Eigen::MatrixXd            &M,
+		                       const Eigen::VectorXd            &q,
+		                       const Eigen::VectorXd            &lowerBound,
+		                       const Eigen::VectorXd            &upperBound,
+		                       Eigen::VectorXd                  &dq);                       // Throws if the solver fails
+
+		static Eigen::Isometry3d to_isometry(const iDynTree::Transform &T);
+
+};                                                                                                  // Semicolon needed after class declaration
+
+#endif
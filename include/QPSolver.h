@@ -3,6 +3,7 @@
 
 #include <Eigen/Dense>                                                                              // Eigen::MatrixXd and matrix decomposition
 #include <iostream>                                                                                 // std::cout, std::cerr
+#include <list>                                                                                     // std::list
 #include <math.h>
 #include <vector>                                                                                   // std::vector
 
@@ -25,29 +26,35 @@ class QPSolver
 		                                               const Eigen::MatrixXd &A);           // Solve a redundant least squares problem
 		                                      
 		// These functions require an object to be created since they use the
-		// interior point solver:
-		Eigen::VectorXd solve(const Eigen::MatrixXd &H,                                     // Solve QP problem with inequality constraints
-		                      const Eigen::VectorXd &f,
-		                      const Eigen::MatrixXd &B,
-		                      const Eigen::VectorXd &z,
-		                      const Eigen::VectorXd &x0);
+		// interior point solver. They work in storage kept for each size of problem,
+		// so after the first call (or reserve()) they don't allocate any memory.
+		// The solution they return is only valid until the next call.
+		const Eigen::VectorXd& solve(const Eigen::Ref<const Eigen::MatrixXd> &H,            // Solve QP problem with inequality constraints
+		                             const Eigen::Ref<const Eigen::VectorXd> &f,
+		                             const Eigen::Ref<const Eigen::MatrixXd> &B,
+		                             const Eigen::Ref<const Eigen::VectorXd> &z,
+		                             const Eigen::Ref<const Eigen::VectorXd> &x0);
 		                                                   
-		Eigen::VectorXd least_squares(const Eigen::VectorXd &y,                             // Solve a constrained least squares problem
-		                              const Eigen::MatrixXd &A,
-		                              const Eigen::MatrixXd &W,
-		                              const Eigen::VectorXd &xMin,
-		                              const Eigen::VectorXd &xMax,
-		                              const Eigen::VectorXd &x0);
+		Eigen::Ref<const Eigen::VectorXd> least_squares(const Eigen::Ref<const Eigen::VectorXd> &y, // Solve a constrained least squares problem
+		                                                const Eigen::Ref<const Eigen::MatrixXd> &A,
+		                                                const Eigen::Ref<const Eigen::MatrixXd> &W,
+		                                                const Eigen::Ref<const Eigen::VectorXd> &xMin,
+		                                                const Eigen::Ref<const Eigen::VectorXd> &xMax,
+		                                                const Eigen::Ref<const Eigen::VectorXd> &x0);
 		                              
-		Eigen::VectorXd redundant_least_squares(const Eigen::VectorXd &xd,                   // Solve a constrained least squares problem
-		                                        const Eigen::MatrixXd &W,
-		                                        const Eigen::VectorXd &y,
-		                                        const Eigen::MatrixXd &A,
-		                                        const Eigen::VectorXd &xMin,
-		                                        const Eigen::VectorXd &xMax,
-		                                        const Eigen::VectorXd &x0);
+		Eigen::Ref<const Eigen::VectorXd> redundant_least_squares(const Eigen::Ref<const Eigen::VectorXd> &xd, // Solve a constrained least squares problem
+		                                                          const Eigen::Ref<const Eigen::MatrixXd> &W,
+		                                                          const Eigen::Ref<const Eigen::VectorXd> &y,
+		                                                          const Eigen::Ref<const Eigen::MatrixXd> &A,
+		                                                          const Eigen::Ref<const Eigen::VectorXd> &xMin,
+		                                                          const Eigen::Ref<const Eigen::VectorXd> &xMax,
+		                                                          const Eigen::Ref<const Eigen::VectorXd> &x0);
+		
+		void reserve(const unsigned int &numVariables,                                      // Allocate the storage for a problem in advance
+		             const unsigned int &numConstraints,
+		             const unsigned int &numEqualities = 0);                                // Only for redundant_least_squares()
 		                              
-		Eigen::VectorXd last_solution() const { return this->lastSolution; }                // As it says on the label
+		const Eigen::VectorXd& last_solution() const { return *this->lastSolution; }        // As it says on the label
 		
 		void clear_last_solution() { this->lastSolutionExists = false; }                    // Clear the last solution
 		
@@ -64,7 +71,34 @@ class QPSolver
 		
 		bool lastSolutionExists = false;
 		
-		Eigen::VectorXd lastSolution;
+		// Everything needed to solve one size of problem
+		struct Workspace
+		{
+			Workspace(const unsigned int &numVariables, const unsigned int &numConstraints);
+			
+			unsigned int numVariables, numConstraints;
+			
+			// Interior point method
+			Eigen::MatrixXd I;                                                          // Hessian of the barrier function
+			Eigen::VectorXd g, dx, x, scaled;                                           // Gradient, Newton step, solution, scaled constraint
+			Eigen::VectorXd d;                                                          // Distance to each constraint
+			Eigen::PartialPivLU<Eigen::MatrixXd> decomposition;                         // For the Newton step
+			
+			// Problem converted to standard form
+			Eigen::MatrixXd H, B;
+			Eigen::VectorXd f, z, startPoint;
+			
+			// Extra terms for least squares problems, sized on first use or by reserve()
+			Eigen::MatrixXd AtW, WinvAt, AWinvAt;
+			Eigen::VectorXd error;
+			Eigen::PartialPivLU<Eigen::MatrixXd> weightDecomposition, multiplierDecomposition;
+		};
+		
+		std::list<Workspace> workspaces;                                                    // std::list so references stay valid
+		
+		const Eigen::VectorXd *lastSolution = nullptr;                                      // Points in to one of the workspaces
+		
+		Workspace& workspace(const unsigned int &numVariables, const unsigned int &numConstraints);
 		                         
 };                                                                                                  // Semicolon needed after class declaration
 
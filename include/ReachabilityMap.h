@@ -0,0 +1,95 @@
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+   //                                                                                                //
+  //              Where each hand can reach, and how well, stored on a grid of voxels              //
+ //                                                                                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef REACHABILITYMAP_H_
+#define REACHABILITYMAP_H_
+
+#include <array>                                                                                    // std::array
+#include <cstdint>                                                                                  // uint8_t, uint32_t
+#include <Eigen/Core>                                                                               // Eigen::Vector3d
+#include <string>                                                                                   // std::string
+#include <vector>                                                                                   // std::vector
+
+// The map is made offline by reachability_builder, which samples joint configurations over the
+// joint limits and records the best manipulability of each hand in every voxel it lands in. On
+// the robot, looking up a position is an index calculation. A voxel scores from 0 to 1 relative
+// to the best in the map for that hand; 0 means the hand never got there, or only got there
+// close to a singularity. Positions are in the world frame, the same as the hand poses.
+//
+// File layout (version 1), in the byte order of the machine that wrote it:
+//
+//     ReachabilityFileHeader
+//     uint8_t left[numVoxels], right[numVoxels]                                                // x fastest, then y, then z
+
+struct ReachabilityFileHeader
+{
+	char     magic[8];                                                                          // "ICUBRCH"
+	uint32_t version;
+	uint32_t byteOrder;                                                                         // 0x01020304 as written
+	uint32_t size[3];                                                                           // Voxels along x, y, z
+	uint32_t reserved;
+	double   lower[3];                                                                          // Corner of the first voxel
+	double   resolution;                                                                        // Length of a side of a voxel
+	float    scale[2];                                                                          // Manipulability of a score of 255
+};
+
+class ReachabilityMap
+{
+	public:
+		enum Hand {left, right};
+
+		ReachabilityMap() {}                                                                // Empty constructor
+
+		ReachabilityMap(const Eigen::Vector3d &lower,                                       // Corner of the box to map
+		                const Eigen::Vector3d &upper,                                       // Opposite corner
+		                const double          &resolution);                                 // Size of a voxel
+
+		bool is_empty() const { return this->voxels[left].empty(); }                        // Nothing loaded
+
+		bool load(const std::string &path);
+
+		bool save(const std::string &path) const;
+
+		void add(const Hand &hand, const Eigen::Vector3d &position, const double &manipulability); // Keeps the best
+
+		bool merge(const ReachabilityMap &other);                                           // Must cover the same box
+
+		double score(const Hand &hand, const Eigen::Vector3d &position) const;              // 0 (unreachable) to 1 (best)
+
+		bool nearest_reachable(const Hand            &hand,
+		                       const Eigen::Vector3d &position,
+		                       const double          &maxDistance,
+		                       Eigen::Vector3d       &nearest) const;                       // Centre of the closest voxel with a score
+
+		unsigned int reachable_voxels(const Hand &hand) const;                              // For reporting
+
+	private:
+
+		Eigen::Vector3d lower = Eigen::Vector3d::Zero();
+
+		double resolution = 0.0;
+
+		std::array<unsigned int,3> size = {{0, 0, 0}};
+
+		std::vector<float> voxels[2];                                                       // Best manipulability, for each hand
+
+		std::array<float,2> best = {{0.0, 0.0}};                                            // Highest in the map, for each hand
+
+		bool index(const Eigen::Vector3d &position, std::array<int,3> &cell) const;         // False if outside the map
+
+		unsigned int flatten(const std::array<int,3> &cell) const
+		{
+			return cell[0] + this->size[0]*(cell[1] + this->size[1]*cell[2]);
+		}
+
+		Eigen::Vector3d centre(const std::array<int,3> &cell) const
+		{
+			return this->lower + this->resolution*Eigen::Vector3d(cell[0] + 0.5, cell[1] + 0.5, cell[2] + 0.5);
+		}
+
+};                                                                                                  // Semicolon needed after class declaration
+
+#endif
@@ -0,0 +1,30 @@
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+   //                                                                                                //
+  //           Options for running a thread in real time: priority, CPU affinity, memory locking    //
+ //                                                                                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef REALTIME_H_
+#define REALTIME_H_
+
+#include <iostream>                                                                                 // std::cerr, std::cout
+#include <string>                                                                                   // std::string
+#include <yarp/os/Bottle.h>                                                                         // yarp::os::Bottle
+
+static constexpr unsigned int maxStackPrefault = 1024*1024;                                         // Well under the default 8 MB thread stack
+
+struct RealTimeOptions
+{
+	int priority = 0;                                                                           // 1 - 99 for SCHED_FIFO, 0 for normal scheduling
+	int cpu      = -1;                                                                          // Core to pin the thread to, -1 for any
+	bool lockMemory = false;                                                                    // mlockall() so pages are never swapped out
+	unsigned int stackPrefault = 256*1024;                                                      // Bytes of stack to touch before starting (if locking)
+};
+
+bool load_real_time_options(const yarp::os::Bottle *bottle, RealTimeOptions &options);              // Get the REAL_TIME group from the config file
+
+bool lock_process_memory();                                                                         // Lock current & future pages in RAM
+
+bool configure_current_thread(const RealTimeOptions &options);                                      // Apply priority, affinity & stack prefault
+
+#endif
@@ -0,0 +1,65 @@
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+   //                                                                                                //
+  //          Lock-free, fixed size queue from one writer thread to one reader thread               //
+ //                                                                                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RINGBUFFER_H_
+#define RINGBUFFER_H_
+
+#include <atomic>                                                                                   // std::atomic
+#include <vector>                                                                                   // std::vector
+
+// Unlike the TripleBuffer, every value is kept in order until the reader takes it. The storage is
+// allocated once in the constructor, and if the reader falls behind then new values are refused
+// rather than the queue growing, so the delay through it is bounded.
+
+template <class T>
+class RingBuffer
+{
+	public:
+		RingBuffer(const unsigned int &capacity = 16) : buffer(capacity + 1) {}             // One slot is always left empty
+
+		bool push(const T &value)                                                           // Writer only; false if full
+		{
+			unsigned int tail = this->tailIndex.load(std::memory_order_relaxed);
+
+			unsigned int next = increment(tail);
+
+			if(next == this->headIndex.load(std::memory_order_acquire)) return false;        // Reader hasn't caught up
+
+			this->buffer[tail] = value;
+
+			this->tailIndex.store(next, std::memory_order_release);
+
+			return true;
+		}
+
+		const T* front() const                                                              // Reader only; nullptr if empty
+		{
+			unsigned int head = this->headIndex.load(std::memory_order_relaxed);
+
+			if(head == this->tailIndex.load(std::memory_order_acquire)) return nullptr;
+
+			return &this->buffer[head];
+		}
+
+		void pop()                                                                          // Reader only; call after front()
+		{
+			this->headIndex.store(increment(this->headIndex.load(std::memory_order_relaxed)), std::memory_order_release);
+		}
+
+		unsigned int capacity() const { return this->buffer.size() - 1; }
+
+	private:
+
+		std::vector<T> buffer;
+
+		std::atomic<unsigned int> headIndex{0};                                             // Next value to read (reader moves it)
+		std::atomic<unsigned int> tailIndex{0};                                             // Next slot to write (writer moves it)
+
+		unsigned int increment(const unsigned int &index) const { return (index + 1) % this->buffer.size(); }
+
+};                                                                                                  // Semicolon needed after class declaration
+
+#endif
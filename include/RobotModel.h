@@ -0,0 +1,25 @@
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+   //                                                                                                //
+  //                   Kinematic model of the arms & torso, with frames for the hands               //
+ //                                                                                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ROBOTMODEL_H_
+#define ROBOTMODEL_H_
+
+#include <iDynTree/Core/Transform.h>                                                               // iDynTree::Transform
+#include <iDynTree/Model/Model.h>                                                                   // iDynTree::Model
+#include <iDynTree/ModelIO/ModelLoader.h>                                                           // Extracts information from URDF
+#include <string>                                                                                   // std::string
+#include <vector>                                                                                   // std::vector
+
+// Everything that works out where the hands are (the control thread, the pre-flight check, the
+// reachability map) has to agree on the hand frames and the pose of the base, so they all get
+// the model from here. The hand frames are called "left" and "right".
+
+iDynTree::Model load_robot_model(const std::string              &pathToURDF,
+                                 const std::vector<std::string> &jointList,
+                                 const std::string              &robotModel,                        // iCub2, iCub3, ergoCub
+                                 iDynTree::Transform            &basePose);                         // Throws on failure
+
+#endif
@@ -0,0 +1,71 @@
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+   //                                                                                                //
+  //         Receives timestamped poses from another module and interpolates between them            //
+ //                                                                                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SETPOINTSTREAM_H_
+#define SETPOINTSTREAM_H_
+
+#include <atomic>                                                                                   // std::atomic
+#include <Eigen/Geometry>                                                                           // Eigen::Isometry3d, Eigen::Quaterniond
+#include <iostream>                                                                                 // std::cerr
+#include <RingBuffer.h>                                                                             // Port thread -> control thread
+#include <Utilities.h>                                                                              // transform_from_vector()
+#include <yarp/os/Bottle.h>                                                                         // yarp::os::Bottle
+#include <yarp/os/BufferedPort.h>                                                                   // yarp::os::BufferedPort
+
+// Each message on the port is a flat list of numbers: the time the poses should be reached, then
+// 6 numbers (x y z & angle*axis) for every pose. One pose is for a grasped object, two are for
+// the left & right hands:
+//
+//     time x y z rx ry rz                           <- object
+//     time x y z rx ry rz x y z rx ry rz            <- left hand, right hand
+
+struct Setpoint
+{
+	double time = 0.0;                                                                          // When the poses should be reached
+	unsigned int numPoses = 0;                                                                  // 1 for the object, 2 for the hands
+	Eigen::Isometry3d pose[2];
+};
+
+class SetpointStream : public yarp::os::TypedReaderCallback<yarp::os::Bottle>
+{
+	public:
+		SetpointStream(const unsigned int &capacity = 32) : queue(capacity) {}
+
+		bool open(const std::string &portName);                                             // Start receiving
+
+		void close();                                                                       // Stop receiving
+
+		void onRead(yarp::os::Bottle &bottle);                                              // Called by the port for every message
+
+		bool interpolate(const double              &time,
+		                 const unsigned int        &numPoses,
+		                 Eigen::Isometry3d         pose[],
+		                 Eigen::Matrix<double,6,1> twist[]);                                // Get the reference (control thread only)
+
+		void discard_before(const double &time);                                            // Start again (control thread only)
+
+		unsigned long dropped() const { return this->droppedCount.load(std::memory_order_relaxed); }
+
+		unsigned long rejected() const { return this->rejectedCount.load(std::memory_order_relaxed); }
+
+	private:
+
+		RingBuffer<Setpoint> queue;                                                         // Port thread -> control thread
+
+		yarp::os::BufferedPort<yarp::os::Bottle> port;
+
+		// Only touched by the control thread
+		Setpoint previous, next;                                                            // Either side of the time being interpolated
+		bool hasPrevious = false, hasNext = false;
+		Setpoint held;                                                                      // Last pose held while the stream was paused
+		bool holding = false;
+
+		std::atomic<unsigned long> droppedCount{0};                                         // Arrived while the queue was full
+		std::atomic<unsigned long> rejectedCount{0};                                        // Badly formed, out of order, or wrong size
+
+};                                                                                                  // Semicolon needed after class declaration
+
+#endif
@@ -0,0 +1,114 @@
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+   //                                                                                                //
+  //        Position-direct joint motors simulated in-process, for running without a robot          //
+ //                                                                                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SIMULATEDMOTORS_H_
+#define SIMULATEDMOTORS_H_
+
+#include <algorithm>                                                                                // std::min, std::max
+#include <array>                                                                                    // std::array
+#include <Eigen/Core>                                                                               // Eigen::VectorXd
+#include <iostream>                                                                                 // std::cerr
+#include <math.h>                                                                                   // M_PI
+#include <mutex>                                                                                    // std::mutex, std::lock_guard
+#include <random>                                                                                   // std::normal_distribution
+#include <vector>                                                                                   // std::vector
+#include <yarp/os/Clock.h>                                                                          // yarp::os::Clock
+#include <yarp/os/SystemClock.h>                                                                    // yarp::os::SystemClock
+#include <yarp/os/Time.h>                                                                           // yarp::os::Time
+
+struct SimulationParameters
+{
+	double latency       = 0.0;                                                                 // Time for a command to reach the motors (s)
+	double noise         = 0.0;                                                                 // Standard deviation on the encoders (rad)
+	double timeScale     = 1.0;                                                                 // Simulated seconds per real second
+	double velocityLimit = 2.0;                                                                 // Default speed limit on all joints (rad/s)
+
+	std::vector<std::array<double,2>> positionLimit;                                            // Lower & upper bound (rad), default is +/- pi
+
+	Eigen::VectorXd initialPosition;                                                            // Default is all zeros
+};
+
+// Runs the clock faster (or slower) than real time. Installed globally so the control loop,
+// the encoder thread and the trajectories all see the same time.
+class ScaledClock : public yarp::os::Clock
+{
+	public:
+		void set_scale(const double &scale);
+
+		double now() override;
+
+		void delay(double seconds) override;
+
+		bool isValid() const override { return true; }
+
+	private:
+
+		double scale     = 1.0;                                                             // Simulated seconds per real second
+		double realStart = 0.0;                                                             // System time when scale was set
+		double simStart  = 0.0;                                                             // Simulated time when scale was set
+
+};                                                                                                  // Semicolon needed after class declaration
+
+class SimulatedMotors
+{
+	public:
+		SimulatedMotors() {}                                                                // Empty constructor
+
+		bool open(const unsigned int &numJoints, const SimulationParameters &parameters);   // Set up the joints
+
+		bool read(Eigen::VectorXd &pos, Eigen::VectorXd &vel, double &time);                // Get the (noisy) joint state
+
+		bool write(const Eigen::VectorXd &commands);                                        // Send position commands, arrives after latency
+
+		std::vector<std::array<double,2>> position_limits() const { return this->positionLimit; }
+
+		std::vector<double> velocity_limits() const { return this->velocityLimit; }
+
+		void close() { this->isOpen = false; }
+
+	private:
+
+		bool isOpen = false;
+
+		unsigned int numJoints = 0;
+
+		double latency = 0.0;                                                               // Command transport delay (s)
+
+		double noiseDeviation = 0.0;                                                        // Standard deviation on encoders (rad)
+
+		double lastUpdate = 0.0;                                                            // Time the joint state was last integrated
+
+		std::mutex mutex;                                                                   // Encoder thread reads while control thread writes
+
+		std::vector<std::array<double,2>> positionLimit;
+
+		std::vector<double> velocityLimit;
+
+		Eigen::VectorXd position, velocity, target;                                         // Actual joint state & current set point
+
+		struct Command
+		{
+			double arrival = 0.0;                                                       // When it reaches the motors
+			Eigen::VectorXd position;
+		};
+		
+		std::vector<Command> inTransit;                                                     // Circular; commands that haven't arrived yet
+		
+		unsigned int oldest = 0, numInTransit = 0;                                          // Position in, and number used of inTransit
+		
+		static constexpr unsigned int maxInTransit = 256;                                   // Way more than the latency needs
+
+		std::default_random_engine generator;
+
+		std::normal_distribution<double> noise{0.0, 1.0};                                   // Scaled by noiseDeviation
+
+		void step(const double &time);                                                      // Move the joints forward in time
+
+		void integrate(const double &duration);                                             // Move toward target at limited speed
+
+};                                                                                                  // Semicolon needed after class declaration
+
+#endif
@@ -0,0 +1,76 @@
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+   //                                                                                                //
+  //          Receives joint, hand or object targets at a high rate, alongside the RPC port          //
+ //                                                                                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TARGETSTREAM_H_
+#define TARGETSTREAM_H_
+
+#include <atomic>                                                                                   // std::atomic
+#include <cstdint>                                                                                  // int32_t
+#include <iCubBase.h>                                                                               // Where the targets go
+#include <vector>                                                                                   // std::vector
+#include <yarp/os/BufferedPort.h>                                                                   // yarp::os::BufferedPort
+#include <yarp/os/ConnectionReader.h>                                                               // yarp::os::ConnectionReader
+#include <yarp/os/ConnectionWriter.h>                                                               // yarp::os::ConnectionWriter
+#include <yarp/os/Portable.h>                                                                       // yarp::os::Portable
+
+// Each message is one target, sent in binary so there is nothing to parse:
+//
+//     int32 type, int32 sequence, float64 time, int32 count, float64 values[count]
+//
+// where the values are the joint positions (rad) for a 'joints' target, x y z rx ry rz for the
+// left & then the right hand for a 'hands' target, and x y z rx ry rz for an 'object' target.
+// The sender should add 1 to the sequence for every message so those that were skipped can be
+// counted. The port only keeps the newest message, so if targets arrive faster than they can be
+// planned the old ones are thrown away rather than queued.
+
+struct StreamedTarget : public yarp::os::Portable
+{
+	enum Type : int32_t {joints, hands, object};
+
+	int32_t type = joints;
+	int32_t sequence = 0;                                                                       // Goes up by 1 for every message
+	double time = 0.0;                                                                          // Seconds to reach the target
+	std::vector<double> values;
+
+	bool read(yarp::os::ConnectionReader &connection) override;
+
+	bool write(yarp::os::ConnectionWriter &connection) const override;
+
+};
+
+class TargetStream : public yarp::os::TypedReaderCallback<StreamedTarget>
+{
+	public:
+		TargetStream(iCubBase *_robot) : robot(_robot) {}
+
+		bool open(const std::string &portName);                                             // Start receiving
+
+		void close();                                                                       // Stop receiving, and report the counts
+
+		void onRead(StreamedTarget &target);                                                // Called by the port for the newest message
+
+		unsigned long received() const { return this->receivedCount.load(std::memory_order_relaxed); }
+
+		unsigned long dropped() const { return this->droppedCount.load(std::memory_order_relaxed); }
+
+		unsigned long rejected() const { return this->rejectedCount.load(std::memory_order_relaxed); }
+
+	private:
+
+		iCubBase *robot;
+
+		yarp::os::BufferedPort<StreamedTarget> port;
+
+		bool hasSequence = false;                                                           // Only touched by the port thread
+		int32_t lastSequence = 0;
+
+		std::atomic<unsigned long> receivedCount{0};                                        // Reached onRead()
+		std::atomic<unsigned long> droppedCount{0};                                         // Overwritten by a newer message
+		std::atomic<unsigned long> rejectedCount{0};                                        // Badly formed, not allowed while grasping, or failed
+
+};                                                                                                  // Semicolon needed after class declaration
+
+#endif
@@ -0,0 +1,65 @@
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+   //                                                                                                //
+  //        Lock-free hand-off of the latest value from one writer thread to one reader thread      //
+ //                                                                                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRIPLEBUFFER_H_
+#define TRIPLEBUFFER_H_
+
+#include <atomic>                                                                                   // std::atomic
+
+// The writer and reader each own one of the three buffers, and the third sits in the middle.
+// Publishing and updating just swap an index with the middle one, so neither side ever waits
+// and the reader always gets the most recent complete value. Older values are overwritten.
+
+template <class T>
+class TripleBuffer
+{
+	public:
+		TripleBuffer() {}                                                                   // Empty constructor
+
+		void fill(const T &value)                                                           // Set all 3 buffers (before threads start)
+		{
+			for(int i = 0; i < 3; i++) this->buffer[i] = value;
+		}
+
+		T& write_buffer() { return this->buffer[this->writeIndex]; }                        // Writer fills this in...
+
+		void publish()                                                                      // ... then swaps it with the middle buffer
+		{
+			unsigned char previous = this->middle.exchange(this->writeIndex | freshBit, std::memory_order_acq_rel);
+
+			this->writeIndex = previous & indexMask;
+		}
+
+		bool update()                                                                       // Reader takes the middle buffer if it is new
+		{
+			if(not (this->middle.load(std::memory_order_acquire) & freshBit)) return false;  // Nothing new since last time
+
+			unsigned char previous = this->middle.exchange(this->readIndex, std::memory_order_acq_rel);
+
+			this->readIndex = previous & indexMask;
+
+			return true;
+		}
+
+		const T& read_buffer() const { return this->buffer[this->readIndex]; }              // Latest value the reader has taken
+
+		T& read_buffer() { return this->buffer[this->readIndex]; }                          // Reader may modify its own copy
+
+	private:
+
+		static constexpr unsigned char freshBit  = 0x4;                                     // Middle buffer hasn't been read yet
+		static constexpr unsigned char indexMask = 0x3;                                     // Bits for the buffer index
+
+		T buffer[3];
+
+		unsigned char writeIndex = 0;                                                       // Only touched by the writer
+		unsigned char readIndex  = 1;                                                       // Only touched by the reader
+
+		std::atomic<unsigned char> middle{2};                                               // Shared index (+ fresh bit)
+
+};                                                                                                  // Semicolon needed after class declaration
+
+#endif
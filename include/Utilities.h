@@ -10,6 +10,7 @@
 #include <Eigen/Geometry>                                                                           // Eigen::Isometry, Eigen::Vector
 #include <iostream>                                                                                 // std::cerr and std::cout
 #include <map>                                                                                      // std::map
+#include <SimulatedMotors.h>                                                                        // SimulationParameters
 #include <vector>                                                                                   // std::vector
 #include <yarp/os/Bottle.h>                                                                         // yarp::os::Bottle
 
@@ -46,4 +47,6 @@ bool load_cartesian_trajectories(const yarp::os::Bottle *bottle,
                                  const std::vector<std::string> nameList,
                                  std::map<std::string,CartesianMotion> &map);
 
+bool load_simulation_parameters(const yarp::os::Bottle *bottle, SimulationParameters &parameters);  // Get the SIMULATION group from the config file
+
 #endif
@@ -30,6 +30,12 @@ service CommandInterface
 
 	bool release_object();                                                                      # As it says on the label
 	
+	bool reload_config();                                                                       # Load the actions & gains from the config files again
+	
+	bool start_streaming();                                                                     # Follow the poses sent to /setpoints
+	
+	string timing_report();                                                                     # Statistics on the control loop timing
+	
 	void stop();                                                                                # Stop the robot moving immediately
 
 	void shut_down();                                                                           # Shut down the command server
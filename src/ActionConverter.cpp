@@ -0,0 +1,38 @@
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+   //                                                                                                //
+  //               Convert the actions in the config files to a binary action file                  //
+ //                                                                                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <ActionFile.h>                                                                             // load_actions(), save_action_file()
+#include <iostream>                                                                                 // std::cerr, std::cout
+#include <yarp/os/Property.h>                                                                       // Load configuration files
+
+int main(int argc, char* argv[])
+{
+	if(argc != 3)
+	{
+		std::cerr << "[ERROR] [ACTION CONVERTER] Paths to the config file and the output are required. "
+		          << "Usage: ./action_converter /path/to/config.ini /path/to/actions.bin\n";
+
+		return 1;
+	}
+
+	yarp::os::Property parameter; parameter.fromConfigFile(argv[1]);                            // Includes the action files
+
+	ActionSet actions;
+
+	if(not load_actions(parameter, actions)) return 1;
+
+	if(not save_action_file(argv[2], actions)) return 1;
+
+	ActionSet check;                                                                            // Make sure it reads back
+
+	if(not load_action_file(argv[2], check)) return 1;
+
+	std::cout << "[INFO] [ACTION CONVERTER] Wrote " << check.joint.size() << " joint, "
+	          << check.left.size() << " left hand, " << check.right.size() << " right hand, and "
+	          << check.grasp.size() << " grasp actions to " << argv[2] << ".\n";
+
+	return 0;
+}
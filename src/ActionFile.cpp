@@ -0,0 +1,360 @@
+#include <ActionFile.h>
+
+#include <cstring>                                                                                  // std::memcpy, std::strncpy, memchr
+#include <fcntl.h>                                                                                  // open()
+#include <fstream>                                                                                  // std::ofstream
+#include <iostream>                                                                                 // std::cerr
+#include <sys/mman.h>                                                                               // mmap(), munmap()
+#include <sys/stat.h>                                                                               // fstat()
+#include <unistd.h>                                                                                 // close()
+
+static const char     actionFileMagic[8] = "ICUBACT";
+static const uint32_t actionFileVersion  = 1;
+static const uint32_t byteOrderMarker    = 0x01020304;
+static const uint32_t poseChannels       = 7;                                                       // x y z qw qx qy qz
+static const uint32_t maxChannels        = 1024;                                                    // More than any robot has joints
+
+enum Group : uint32_t {jointGroup, leftGroup, rightGroup, graspGroup};
+
+static_assert(sizeof(ActionFileHeader) == 24 and sizeof(ActionRecord) == 72, "The action file layout has changed");
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                          Get all the actions from the groups in the config files               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool load_actions(const yarp::os::Property &parameter, ActionSet &actions)
+{
+	actions = ActionSet();                                                                      // Start empty
+
+	// Joint space actions
+	yarp::os::Bottle *bottle = &parameter.findGroup("JOINT_SPACE_ACTIONS");
+
+	if(bottle->isNull())
+	{
+		std::cerr << "[ERROR] load_actions(): No group called JOINT_SPACE_ACTIONS could be found.\n";
+
+		return false;
+	}
+
+	if(not load_joint_configurations(bottle, actions.joint)) return false;
+
+	// Cartesian actions for the hands, which share the same list of names
+	std::vector<std::string> nameList = string_from_bottle(parameter.findGroup("CARTESIAN_ACTIONS").find("names").asList());
+
+	bottle = parameter.findGroup("CARTESIAN_ACTIONS").find("left").asList();
+
+	if(bottle == nullptr)
+	{
+		std::cerr << "[ERROR] load_actions(): No list called 'left' in the CARTESIAN_ACTIONS group could be found.\n";
+
+		return false;
+	}
+
+	if(not load_cartesian_trajectories(bottle, nameList, actions.left)) return false;
+
+	bottle = parameter.findGroup("CARTESIAN_ACTIONS").find("right").asList();
+
+	if(bottle == nullptr)
+	{
+		std::cerr << "[ERROR] load_actions(): No list called 'right' in the CARTESIAN_ACTIONS group could be found.\n";
+
+		return false;
+	}
+
+	if(not load_cartesian_trajectories(bottle, nameList, actions.right)) return false;
+
+	// Actions for a grasped object
+	bottle = &parameter.findGroup("GRASP_ACTIONS");
+
+	if(bottle->isNull())
+	{
+		std::cerr << "[ERROR] load_actions(): Could not find the group called GRASP_ACTIONS.\n";
+
+		return false;
+	}
+
+	nameList = string_from_bottle(bottle->find("names").asList());
+
+	return load_cartesian_trajectories(bottle, nameList, actions.grasp);
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                      Map a binary action file and copy the actions out of it                   //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool load_action_file(const std::string &path, ActionSet &actions)
+{
+	int file = open(path.c_str(), O_RDONLY);
+
+	if(file < 0)
+	{
+		std::cerr << "[ERROR] load_action_file(): Could not open " << path << ".\n";
+
+		return false;
+	}
+
+	struct stat status;
+
+	if(fstat(file, &status) != 0 or status.st_size < (off_t)sizeof(ActionFileHeader))
+	{
+		std::cerr << "[ERROR] load_action_file(): " << path << " is too small to be an action file.\n";
+
+		close(file);
+
+		return false;
+	}
+
+	const uint64_t fileSize = status.st_size;
+
+	void *mapping = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, file, 0);
+
+	close(file);                                                                                // The mapping stays valid without it
+
+	if(mapping == MAP_FAILED)
+	{
+		std::cerr << "[ERROR] load_action_file(): Could not map " << path << " in to memory.\n";
+
+		return false;
+	}
+
+	const char *start = static_cast<const char*>(mapping);
+
+	ActionFileHeader header;
+	std::memcpy(&header, start, sizeof(header));
+
+	std::string problem;                                                                        // Empty if the file is good
+
+	if(std::memcmp(header.magic, actionFileMagic, sizeof(actionFileMagic)) != 0)
+	{
+		problem = "it is not an action file";
+	}
+	else if(header.byteOrder != byteOrderMarker)
+	{
+		problem = "it was written on a machine with the opposite byte order";
+	}
+	else if(header.version != actionFileVersion)
+	{
+		problem = "it is version " + std::to_string(header.version) + " but version "
+		        + std::to_string(actionFileVersion) + " is required";
+	}
+	else if((fileSize - sizeof(header)) / sizeof(ActionRecord) < header.numActions)
+	{
+		problem = "the table of actions runs past the end of the file";
+	}
+
+	ActionSet loaded;
+
+	for(uint32_t i = 0; i < header.numActions and problem.empty(); i++)
+	{
+		ActionRecord record;
+		std::memcpy(&record, start + sizeof(header) + i*sizeof(ActionRecord), sizeof(record));
+
+		if(memchr(record.name, '\0', sizeof(record.name)) == nullptr)
+		{
+			problem = "action " + std::to_string(i) + " has no name";
+			break;
+		}
+
+		std::string name(record.name);
+
+		if(record.group > graspGroup
+		or record.type > absolute
+		or record.numPoints == 0
+		or record.numChannels == 0
+		or record.numChannels > maxChannels
+		or (record.group != jointGroup and record.numChannels != poseChannels))
+		{
+			problem = "the '" + name + "' action has an invalid description";
+			break;
+		}
+
+		if(record.offset % sizeof(double) != 0
+		or record.offset > fileSize
+		or (fileSize - record.offset) / sizeof(double) / (record.numChannels + 1) < record.numPoints)
+		{
+			problem = "the data for the '" + name + "' action is outside the file";
+			break;
+		}
+
+		// Read in place: the times, then one array for each channel
+		const double *times = reinterpret_cast<const double*>(start + record.offset);
+		const double *value = times + record.numPoints;
+		const uint32_t n    = record.numPoints;
+
+		if(record.group == jointGroup)
+		{
+			JointTrajectory trajectory;
+			trajectory.times.assign(times, times + n);
+			trajectory.waypoints.assign(n, Eigen::VectorXd(record.numChannels));
+
+			for(uint32_t j = 0; j < record.numChannels; j++)
+			{
+				for(uint32_t k = 0; k < n; k++) trajectory.waypoints[k](j) = value[(size_t)j*n + k];
+			}
+
+			loaded.joint.emplace(name, trajectory);
+		}
+		else
+		{
+			CartesianMotion motion;
+			motion.type = static_cast<Type>(record.type);
+			motion.times.assign(times, times + n);
+
+			for(uint32_t k = 0; k < n; k++)
+			{
+				Eigen::Quaterniond orientation(value[3*n + k], value[4*n + k], value[5*n + k], value[6*n + k]);
+
+				Eigen::Isometry3d pose(orientation.normalized());
+				pose.translation() << value[k], value[n + k], value[2*n + k];
+
+				motion.waypoints.push_back(pose);
+			}
+
+			if     (record.group == leftGroup)  loaded.left.emplace(name, motion);
+			else if(record.group == rightGroup) loaded.right.emplace(name, motion);
+			else                                loaded.grasp.emplace(name, motion);
+		}
+	}
+
+	munmap(mapping, fileSize);
+
+	if(not problem.empty())
+	{
+		std::cerr << "[ERROR] load_action_file(): Could not load " << path << " because " << problem << ".\n";
+
+		return false;
+	}
+
+	actions = std::move(loaded);
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                 Write the actions to a binary file                             //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool save_action_file(const std::string &path, const ActionSet &actions)
+{
+	std::vector<ActionRecord> records;
+	std::vector<double> data;                                                                   // Everything after the table
+
+	// Start a new record, and put its times in the data
+	auto add_record = [&](const std::string &name,
+	                      const Group &group,
+	                      const Type &type,
+	                      const std::vector<double> &times,
+	                      const uint32_t &numChannels) -> bool
+	{
+		if(name.size() >= sizeof(ActionRecord::name))
+		{
+			std::cerr << "[ERROR] save_action_file(): The name '" << name << "' is longer than "
+			          << sizeof(ActionRecord::name) - 1 << " characters.\n";
+
+			return false;
+		}
+
+		ActionRecord record;
+		std::memset(&record, 0, sizeof(record));
+		std::strncpy(record.name, name.c_str(), sizeof(record.name) - 1);
+		record.group       = group;
+		record.type        = type;
+		record.numPoints   = times.size();
+		record.numChannels = numChannels;
+		record.offset      = data.size();                                                   // Shifted past the table below
+
+		records.push_back(record);
+
+		data.insert(data.end(), times.begin(), times.end());
+
+		return true;
+	};
+
+	for(const auto &entry : actions.joint)
+	{
+		const std::vector<Eigen::VectorXd> &waypoints = entry.second.waypoints;
+
+		if(waypoints.empty() or waypoints.size() != entry.second.times.size())
+		{
+			std::cerr << "[ERROR] save_action_file(): The '" << entry.first << "' joint action "
+			          << "has " << waypoints.size() << " waypoints and " << entry.second.times.size() << " times.\n";
+
+			return false;
+		}
+
+		for(const auto &waypoint : waypoints)
+		{
+			if(waypoint.size() != waypoints.front().size())
+			{
+				std::cerr << "[ERROR] save_action_file(): The waypoints of the '" << entry.first
+				          << "' joint action are not all the same size.\n";
+
+				return false;
+			}
+		}
+
+		if(not add_record(entry.first, jointGroup, absolute, entry.second.times, waypoints.front().size())) return false;
+
+		for(int j = 0; j < waypoints.front().size(); j++)
+		{
+			for(const auto &waypoint : waypoints) data.push_back(waypoint(j));
+		}
+	}
+
+	const std::map<std::string, CartesianMotion> *cartesian[3] = {&actions.left, &actions.right, &actions.grasp};
+	const Group cartesianGroup[3] = {leftGroup, rightGroup, graspGroup};
+
+	for(int i = 0; i < 3; i++)
+	{
+		for(const auto &entry : *cartesian[i])
+		{
+			const std::vector<Eigen::Isometry3d> &waypoints = entry.second.waypoints;
+
+			if(waypoints.empty() or waypoints.size() != entry.second.times.size())
+			{
+				std::cerr << "[ERROR] save_action_file(): The '" << entry.first << "' Cartesian action "
+				          << "has " << waypoints.size() << " waypoints and " << entry.second.times.size() << " times.\n";
+
+				return false;
+			}
+
+			if(not add_record(entry.first, cartesianGroup[i], entry.second.type, entry.second.times, poseChannels)) return false;
+
+			for(int j = 0; j < 3; j++)
+			{
+				for(const auto &pose : waypoints) data.push_back(pose.translation()(j));
+			}
+
+			std::vector<Eigen::Quaterniond> orientations;
+			for(const auto &pose : waypoints) orientations.emplace_back(pose.rotation());
+
+			for(const auto &q : orientations) data.push_back(q.w());
+			for(const auto &q : orientations) data.push_back(q.x());
+			for(const auto &q : orientations) data.push_back(q.y());
+			for(const auto &q : orientations) data.push_back(q.z());
+		}
+	}
+
+	ActionFileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, actionFileMagic, sizeof(actionFileMagic));
+	header.version    = actionFileVersion;
+	header.byteOrder  = byteOrderMarker;
+	header.numActions = records.size();
+
+	const uint64_t dataStart = sizeof(header) + records.size()*sizeof(ActionRecord);         // A multiple of 8
+
+	for(auto &record : records) record.offset = dataStart + record.offset*sizeof(double);
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(records.data()), records.size()*sizeof(ActionRecord));
+	file.write(reinterpret_cast<const char*>(data.data()), data.size()*sizeof(double));
+
+	if(not file)
+	{
+		std::cerr << "[ERROR] save_action_file(): Could not write to " << path << ".\n";
+
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,82 @@
+#include <AllocationTracker.h>
+
+#ifdef CHECK_ALLOCATIONS
+
+#include <cstdlib>                                                                                  // std::abort
+#include <cstddef>                                                                                  // size_t
+#include <iostream>                                                                                 // std::cerr
+
+// glibc's own allocator, which the functions below hand on to
+extern "C"
+{
+	void* __libc_malloc(size_t size);
+	void* __libc_calloc(size_t number, size_t size);
+	void* __libc_realloc(void *pointer, size_t size);
+	void* __libc_memalign(size_t alignment, size_t size);
+}
+
+static thread_local bool checking = false;                                                          // Only count in the thread being checked
+static thread_local unsigned long allocations = 0;
+static thread_local size_t firstSize = 0;                                                           // Helps to find the culprit
+
+static inline void count(const size_t &size)
+{
+	if(not checking) return;
+
+	if(allocations == 0) firstSize = size;
+
+	allocations++;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                 Replacements for the C allocation functions (operator new calls these)         //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+extern "C"
+{
+	void* malloc(size_t size) { count(size); return __libc_malloc(size); }
+
+	void* calloc(size_t number, size_t size) { count(number*size); return __libc_calloc(number, size); }
+
+	void* realloc(void *pointer, size_t size) { count(size); return __libc_realloc(pointer, size); }
+
+	void* memalign(size_t alignment, size_t size) { count(size); return __libc_memalign(alignment, size); }
+
+	void* aligned_alloc(size_t alignment, size_t size) { count(size); return __libc_memalign(alignment, size); }
+
+	int posix_memalign(void **pointer, size_t alignment, size_t size)
+	{
+		count(size);
+
+		*pointer = __libc_memalign(alignment, size);
+
+		return *pointer == nullptr ? 12 : 0;                                                 // ENOMEM
+	}
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                            Start counting allocations in this thread                           //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void begin_allocation_check()
+{
+	allocations = 0;
+
+	checking = true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                           Stop counting, and abort if anything was allocated                   //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void end_allocation_check(const char *where)
+{
+	checking = false;
+
+	if(allocations > 0)
+	{
+		std::cerr << "[ERROR] end_allocation_check(): " << where << " allocated memory "
+		          << allocations << " time(s). The first was " << firstSize << " bytes.\n";
+
+		std::abort();
+	}
+}
+
+#endif
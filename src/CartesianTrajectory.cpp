@@ -27,60 +27,89 @@ CartesianTrajectory::CartesianTrajectory(const std::vector<Eigen::Isometry3d> &p
 	}
 	else
 	{
-		std::vector<std::vector<double>> points; points.resize(6);                          // 6 dimension in 3D space
-		for(int i = 0; i < 6; i++) points[i].resize(this->numPoses);
+		Eigen::MatrixXd points(6,this->numPoses);                                           // 6 dimensions in 3D space, one column per pose
 		
-		// Extract all the positions and euler angles for each pose
-		for(int i = 0; i < this->numPoses; i++)
-		{
-			// Extract the translation and put it in the points array
-			Eigen::Vector3d translation = poses[i].translation();
-			for(int j = 0; j < 3; j++) points[j][i] = translation[j];
-			
-			// Extract the angle & axis from the SO(3) matrix
-			Eigen::Matrix3d R = poses[i].rotation();                                    // Get the rotation matrix
-			double trace = R(0,0) + R(1,1) + R(2,2);                                    // Get the trace
-			double angle = acos((trace - 1)/2);                                         // Compute the angle
-			if(angle > M_PI) angle = 2*M_PI - angle;                                    // Ensure the range is [-3.14159, 3.14159]
-			
-			// Orientation component = angle*axis
-			points[3][i] = angle*(R(2,1)-R(1,2));                                       // x component
-			points[4][i] = angle*(R(0,2)-R(2,0));                                       // y component
-			points[5][i] = angle*(R(1,0)-R(0,1));                                       // z component
-		}
+		for(int i = 0; i < this->numPoses; i++) points.col(i) = pose_vector(poses[i]);
 		 
-		// Now insert them in to the iDynTree::CubicSpline object
-		this->spline.resize(6);
-		for(int i = 0; i < 6; i++)
-		{
-			if(not this->spline[i].setData(iDynTree::VectorDynSize(times), iDynTree::VectorDynSize(points[i])))
-			{
-				errorMessage += "Unable to set the spline data.";
-				throw std::runtime_error(errorMessage);
-			}
-			else this->spline[i].setInitialConditions(startVelocity[i],0.0);
-		}
+		this->spline = MultiSpline(points, times, startVelocity);                           // Coefficients are solved here, not in the control thread
 	}
 }
 
   ////////////////////////////////////////////////////////////////////////////////////////////////////
- //                          Get the desired pose for the given time                               //
+ //            Start a compiled trajectory from the given pose, velocity & acceleration            //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-Eigen::Isometry3d CartesianTrajectory::get_pose(const double &time)
+CartesianTrajectory::CartesianTrajectory(const MultiSpline               &compiled,
+                                         const Eigen::Isometry3d         &startPose,
+                                         const Eigen::Matrix<double,6,1> &startVelocity,
+                                         const Eigen::Matrix<double,6,1> &startAcceleration)
+                                         :
+                                         numPoses(compiled.num_points()),
+                                         spline(compiled)                                   // Shares the coefficients
 {
-	// NOTE TO FUTURE SELF:
-	// There are no controls here if this function is called before the trajectory
-	// is fully constructed...
-	
-	double pos[3];                                                                              // Position vector
-	double rot[3];                                                                              // Angle*axis vector
+	if(compiled.dimensions() != 6)
+	{
+		throw std::invalid_argument("[ERROR] [CARTESIAN TRAJECTORY] Constructor: "
+		                            "Expected a spline with 6 dimensions, but it had "
+		                            + std::to_string(compiled.dimensions()) + ".");
+	}
 	
-	for(int i = 0; i < 3; i++)
+	this->spline.set_start(pose_vector(startPose), startVelocity, startAcceleration);           // Superimposed on the compiled solution
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //         Solve the spline through the poses now, so it can be started from anywhere later       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+MultiSpline CartesianTrajectory::compile(const std::vector<Eigen::Isometry3d> &poses,
+                                         const std::vector<double>            &times)
+{
+	if(poses.size() != times.size() or poses.size() == 0)
 	{
-		pos[i] = this->spline[ i ].evaluatePoint(time);
-		rot[i] = this->spline[i+3].evaluatePoint(time);
+		throw std::invalid_argument("[ERROR] [CARTESIAN TRAJECTORY] compile(): "
+		                            "Pose vector had " + std::to_string(poses.size()) + " elements, and the "
+		                            "time vector had " + std::to_string(times.size()) + " elements.");
 	}
 	
+	Eigen::MatrixXd points = Eigen::MatrixXd::Zero(6,poses.size()+1);                          // First column is a placeholder for the start
+	
+	std::vector<double> t(1,0.0);                                                               // Start immediately
+	t.insert(t.end(),times.begin(),times.end());
+	
+	for(int i = 0; i < poses.size(); i++) points.col(i+1) = pose_vector(poses[i]);
+	
+	return MultiSpline(points, t);
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //              Convert a pose to the position & angle*axis vector that is interpolated           //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::Matrix<double,6,1> CartesianTrajectory::pose_vector(const Eigen::Isometry3d &pose)
+{
+	Eigen::Matrix<double,6,1> vector;
+	
+	vector.head(3) = pose.translation();                                                        // Position component
+	
+	// Extract the angle & axis from the SO(3) matrix
+	Eigen::Matrix3d R = pose.rotation();                                                        // Get the rotation matrix
+	double trace = R(0,0) + R(1,1) + R(2,2);                                                    // Get the trace
+	double angle = acos((trace - 1)/2);                                                         // Compute the angle
+	if(angle > M_PI) angle = 2*M_PI - angle;                                                    // Ensure the range is [-3.14159, 3.14159]
+	
+	// Orientation component = angle*axis
+	vector(3) = angle*(R(2,1)-R(1,2));                                                          // x component
+	vector(4) = angle*(R(0,2)-R(2,0));                                                          // y component
+	vector(5) = angle*(R(1,0)-R(0,1));                                                          // z component
+	
+	return vector;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                   Convert an interpolated position & angle*axis vector back to a pose          //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::Isometry3d CartesianTrajectory::vector_pose(const Eigen::Ref<const Eigen::Matrix<double,6,1>> &point)
+{
+	const double *pos = point.data();                                                           // Position vector
+	const double *rot = point.data() + 3;                                                       // Angle*axis vector
+	
 	double angle = sqrt(rot[0]*rot[0] + rot[1]*rot[1] + rot[2]*rot[2]);                         // Norm of vector
 	
 	Eigen::Vector3d axis;
@@ -91,6 +120,22 @@ Eigen::Isometry3d CartesianTrajectory::get_pose(const double &time)
 	return Eigen::Translation3d(pos[0],pos[1],pos[2])*Eigen::AngleAxisd(angle,axis);
 }
 
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                          Get the desired pose for the given time                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::Isometry3d CartesianTrajectory::get_pose(const double &time)
+{
+	// NOTE TO FUTURE SELF:
+	// There are no controls here if this function is called before the trajectory
+	// is fully constructed...
+	
+	Eigen::Matrix<double,6,1> point;                                                            // Position & angle*axis
+	
+	this->spline.evaluate(time, point);
+	
+	return vector_pose(point);
+}
+
   ////////////////////////////////////////////////////////////////////////////////////////////////////
  //                          Get the desired state for the given time                              //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -99,23 +144,36 @@ bool CartesianTrajectory::get_state(Eigen::Isometry3d         &pose,
                                     Eigen::Matrix<double,6,1> &acc,
                                     const double              &time)
 {
-	double pos[3];                                                                              // Position vector
-	double rot[3];                                                                              // Angle*axis
+	Eigen::Matrix<double,6,1> point;                                                            // Position & angle*axis
+
+	if(not this->spline.evaluate(time, point, vel, acc)) return false;
+
+	pose = vector_pose(point);
 
-	for(int i = 0; i < 3; i++)
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                     Get the desired state for many times in one call                           //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool CartesianTrajectory::sample(const std::vector<double>      &times,
+                                 std::vector<Eigen::Isometry3d> &poses,
+                                 Eigen::Ref<Eigen::MatrixXd>    twists,
+                                 Eigen::Ref<Eigen::MatrixXd>    accelerations) const
+{
+	if(poses.size() != times.size())
 	{
-		pos[i] = this->spline[ i ].evaluatePoint(time, vel[i]  , acc[i]);
-		rot[i] = this->spline[i+3].evaluatePoint(time, vel[i+3], acc[i+3]);
+		std::cerr << "[ERROR] [CARTESIAN TRAJECTORY] sample(): "
+		          << "There were " << times.size() << " times but space for " << poses.size() << " poses.\n";
+		
+		return false;
 	}
-
-	double angle = sqrt(rot[0]*rot[0] + rot[1]*rot[1] + rot[2]*rot[2]);                         // Norm of vector
 	
-	Eigen::Vector3d axis;
+	Eigen::MatrixXd points(6, times.size());                                                    // Position & angle*axis for each time
 	
-	if(angle == 0) axis = Eigen::Vector3d::UnitX();                                             // Axis is trivial
-	else           axis = Eigen::Vector3d(rot[0]/angle,rot[1]/angle,rot[2]/angle);
+	if(not this->spline.sample(times, points, twists, accelerations)) return false;
+	
+	for(int i = 0; i < times.size(); i++) poses[i] = vector_pose(points.col(i));
 	
-	pose = Eigen::Translation3d(pos[0],pos[1],pos[2])*Eigen::AngleAxisd(angle,axis);
-
 	return true;
 }
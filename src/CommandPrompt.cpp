@@ -15,21 +15,15 @@ std::string errorMessage = "[ERROR] [COMMAND PROMPT] ";
 
 std::map<std::string,int> commandList;                                                             // 0 = Joint command, 1 = Cartesian command
 
-int main(int argc, char* argv[])
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                        Get the names of all the actions from the config file                   //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void load_command_list(const std::string &pathToConfig)
 {
-	// Minimum is 1, but I don't know why ¯\_(ツ)_/¯
-	if(argc != 3)
-	{
-		std::cerr << errorMessage << "Path to configuration file required. "
-		          << "Usage: ./command_prompt /serverPortName /path/to/config.ini\n";
-		          
-		return 1;
-	}
-	
-	std::string serverPortName = argv[1];
+	commandList.clear();                                                                        // In case this is a reload
 	
 	// Load the list of predefined joint configuration names
-	yarp::os::Property parameter; parameter.fromConfigFile(argv[2]);                            // Load the properties from the config file
+	yarp::os::Property parameter; parameter.fromConfigFile(pathToConfig);                       // Load the properties from the config file
 	yarp::os::Bottle* bottle = parameter.findGroup("JOINT_SPACE_ACTIONS").find("names").asList();
 	std::vector<std::string> names = string_from_bottle(bottle);                                // Get the list of the configuration names
 	for(int i = 0; i < names.size(); i++) commandList.emplace(names[i],0);                      // Put them in to the map
@@ -43,6 +37,22 @@ int main(int argc, char* argv[])
 	bottle->clear(); bottle = parameter.findGroup("GRASP_ACTIONS").find("names").asList();
 	names = string_from_bottle(bottle);
 	for(int i = 0; i < names.size(); i++) commandList.emplace(names[i],2);
+}
+
+int main(int argc, char* argv[])
+{
+	// Minimum is 1, but I don't know why ¯\_(ツ)_/¯
+	if(argc != 3)
+	{
+		std::cerr << errorMessage << "Path to configuration file required. "
+		          << "Usage: ./command_prompt /serverPortName /path/to/config.ini\n";
+		          
+		return 1;
+	}
+	
+	std::string serverPortName = argv[1];
+	
+	load_command_list(argv[2]);                                                                 // Names of all the actions
 	
 	yarp::os::Network yarp; 
 	
@@ -101,6 +111,24 @@ int main(int argc, char* argv[])
 			output.addString("Capito");
 			client.release_object();
 		}
+		else if(command == "stream")
+		{
+			output.addString("Avanti");
+			client.start_streaming();
+		}
+		else if(command == "timing")
+		{
+			output.addString(client.timing_report());
+		}
+		else if(command == "reload")
+		{
+			if(client.reload_config())
+			{
+				load_command_list(argv[2]);                                         // Pick up any new names
+				output.addString("Ricaricato");
+			}
+			else output.addString("Problema");
+		}
 		else
 		{
 			auto blah = commandList.find(command);
@@ -4,14 +4,171 @@
  //                                                                                               //
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <ActionFile.h>                                                                             // Loading the actions
+#include <ActionLibrary.h>                                                                          // Actions solved in advance
 #include <CommandInterface.h>                                                                       // thrift-generated class
 #include <iostream>                                                                                 // std::cerr, std::cout
 #include <map>                                                                                      // std::map
+#include <memory>                                                                                   // std::shared_ptr, std::atomic_load
 #include <PositionControl.h>                                                                        // For control of ergoCub, iCub robots
+#include <TargetStream.h>                                                                           // Targets streamed alongside the RPC port
 #include <Utilities.h>                                                                              // JointTrajectory object structure
 #include <yarp/os/Property.h>                                                                       // Load configuration files
 #include <yarp/os/RpcServer.h>                                                                      // Allows communication over yarp ports
 
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //             Everything loaded from the action configs, which is replaced as a whole            //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+struct ActionStore
+{
+	ActionSet source;                                                                           // As listed in the config files
+	
+	ActionLibrary jointActions, handActions, graspActions;                                      // Absolute actions, solved in advance
+};
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                    Solve the splines for all the absolute actions in advance                   //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool compile_actions(PositionControl &robot, ActionStore &store)
+{
+	try
+	{
+		for(const auto &entry : store.source.joint)                                             // Joint actions are always absolute
+		{
+			CompiledAction action;
+			
+			if(not robot.compile_joint_motion(entry.second.waypoints, entry.second.times, action.first)
+			or not store.jointActions.add(entry.first, action))
+			{
+				std::cerr << "[ERROR] [iCUB COMMAND SERVER] compile_actions(): "
+				          << "Could not compile the joint action '" << entry.first << "'.\n";
+				
+				return false;
+			}
+		}
+		
+		for(const auto &left : store.source.left)
+		{
+			auto right = store.source.right.find(left.first);
+			
+			if(left.second.type != absolute or right == store.source.right.end()) continue;          // Built when called
+			
+			CompiledAction action;
+			action.first  = CartesianTrajectory::compile(left.second.waypoints, left.second.times);
+			action.second = CartesianTrajectory::compile(right->second.waypoints, right->second.times);
+			
+			if(not store.handActions.add(left.first, action)) return false;
+		}
+		
+		for(const auto &entry : store.source.grasp)
+		{
+			if(entry.second.type != absolute) continue;
+			
+			CompiledAction action;
+			action.first = CartesianTrajectory::compile(entry.second.waypoints, entry.second.times);
+			
+			if(not store.graspActions.add(entry.first, action)) return false;
+		}
+		
+		std::cout << "[INFO] [iCUB COMMAND SERVER] Compiled " << store.jointActions.size() << " joint, "
+		          << store.handActions.size() << " Cartesian, and " << store.graspActions.size() << " grasp actions.\n";
+		
+		return true;
+	}
+	catch(std::exception &exception)
+	{
+		std::cerr << "[ERROR] [iCUB COMMAND SERVER] compile_actions(): "
+		          << "Could not compile the Cartesian actions.\n";
+		
+		std::cout << exception.what() << std::endl;
+		
+		return false;
+	}
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                   Make a file name in the config file relative to the config file              //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::string beside_config(const std::string &pathToConfig, const std::string &fileName)
+{
+	if(fileName.empty() or fileName.front() == '/') return fileName;                            // Already absolute
+	
+	size_t slash = pathToConfig.find_last_of('/');
+	
+	return slash == std::string::npos ? fileName : pathToConfig.substr(0, slash + 1) + fileName;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //             Load the actions, either from the config files or a binary file, and solve them    //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::shared_ptr<const ActionStore> load_action_store(PositionControl            &robot,
+                                                     const yarp::os::Property   &parameter,
+                                                     const std::string          &pathToConfig)
+{
+	std::shared_ptr<ActionStore> store = std::make_shared<ActionStore>();
+	
+	if(parameter.check("action_file"))                                                          // Converted in advance
+	{
+		std::string actionFile = beside_config(pathToConfig, parameter.find("action_file").asString());
+		
+		if(not load_action_file(actionFile, store->source)) return nullptr;
+	}
+	else if(not load_actions(parameter, store->source))
+	{
+		std::cerr << "[ERROR] [iCUB COMMAND SERVER] load_action_store(): "
+		          << "Could not load the actions from " << pathToConfig << ".\n";
+		
+		return nullptr;
+	}
+	
+	if(not compile_actions(robot, *store)) return nullptr;
+	
+	return store;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                    Set the gains & trajectory options listed in the config files               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool load_gains(PositionControl &robot, const yarp::os::Property &parameter)
+{
+	// Read everything first, so a bad value leaves the old settings untouched
+	GainSettings gains;
+	gains.cartesianProportional = parameter.findGroup("CARTESIAN_GAINS").find("proportional").asFloat64();
+	gains.cartesianDerivative   = parameter.findGroup("CARTESIAN_GAINS").find("derivative").asFloat64();
+	gains.jointProportional     = parameter.findGroup("JOINT_GAINS").find("proportional").asFloat64();
+	gains.jointDerivative       = parameter.findGroup("JOINT_GAINS").find("derivative").asFloat64();
+	gains.maxDamping            = parameter.findGroup("SINGULARITY_AVOIDANCE").find("maxDamping").asFloat64();
+	gains.threshold             = parameter.findGroup("SINGULARITY_AVOIDANCE").find("threshold").asFloat64();
+	gains.actuationLatency      = parameter.findGroup("LATENCY_COMPENSATION").check("actuation",      yarp::os::Value(0.0)).asFloat64();
+	gains.maxPrediction         = parameter.findGroup("LATENCY_COMPENSATION").check("max_prediction", yarp::os::Value(0.05)).asFloat64();
+	
+	bool   blend      = parameter.findGroup("TRAJECTORY").check("blend",       yarp::os::Value(1)).asInt32() != 0;
+	bool   retime     = parameter.findGroup("TRAJECTORY").check("retime",      yarp::os::Value(0)).asInt32() != 0;
+	double limitScale = parameter.findGroup("TRAJECTORY").check("limit_scale", yarp::os::Value(0.8)).asFloat64();
+	bool   preflight  = parameter.findGroup("PREFLIGHT").check("check", yarp::os::Value(0)).asInt32() != 0;
+	
+	if(not iCubBase::check_gains(gains)) return false;
+	
+	if(limitScale <= 0 or limitScale > 1)
+	{
+		std::cerr << "[ERROR] [iCUB COMMAND SERVER] load_gains(): "
+		          << "The limit_scale must be between 0 and 1, but it was " << limitScale << ".\n";
+		
+		return false;
+	}
+	
+	// Rehearse each action on a copy of the kinematics. This is the only step that can still fail
+	if(not robot.enable_preflight(preflight)) return false;
+	
+	robot.set_gains(gains);                                                                     // Already checked, so the whole set goes at once
+	
+	// New Cartesian actions carry on from the reference of a running one, instead of the measured pose
+	robot.set_trajectory_blending(blend);
+	
+	// Joint actions can ignore their times and go as fast as the motor limits allow
+	return robot.set_trajectory_retiming(retime, limitScale);
+}
+
   ///////////////////////////////////////////////////////////////////////////////////////////////////
  //                 Overrides the functions specified in CommandInterface.thrift                  //
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -19,17 +176,13 @@ class CommandServer : public CommandInterface
 {
 	public:
 	
-		CommandServer(PositionControl *_robot,
-		              std::map<std::string,JointTrajectory> *_jointActionMap,
-		              std::map<std::string,CartesianMotion> *_leftHandMap,
-		              std::map<std::string,CartesianMotion> *_rightHandMap,
-		              std::map<std::string,CartesianMotion> *_graspActionMap)
+		CommandServer(PositionControl                    *_robot,
+		              const std::string                  &_pathToConfig,
+		              std::shared_ptr<const ActionStore> _actions)
 		             :
 		             robot(_robot),
-		             jointActionMap(_jointActionMap),
-		             leftHandMap(_leftHandMap),
-		             rightHandMap(_rightHandMap),
-		             graspActionMap(_graspActionMap) {}        
+		             pathToConfig(_pathToConfig),
+		             actions(_actions) {}
 		
 		std::string errorMessage = "[ERROR] [iCUB COMMAND SERVER] ";
 		std::string graspMessage = "I'm currently holding something! You need to call 'release_object()'.\n";
@@ -46,6 +199,9 @@ class CommandServer : public CommandInterface
 		// Query if the robot is finished moving
 		bool is_finished() { return this->robot->is_finished(); }
 		
+		// Get statistics on the control loop timing
+		std::string timing_report() { return this->robot->loop_timer().report(); }
+		
 		// Move the hands by prescribed action
 		bool perform_cartesian_action(const std::string& actionName)
 		{
@@ -56,15 +212,22 @@ class CommandServer : public CommandInterface
 				return false;
 			}
 			
+			std::shared_ptr<const ActionStore> actions = std::atomic_load(&this->actions);  // Kept alive even if reloaded meanwhile
+			
+			if(const CompiledAction *action = actions->handActions.find(actionName))
+			{
+				return this->robot->move_to_poses(action->first, action->second);   // Already solved
+			}
+			
 			// Variables used in this scope
 			std::vector<Eigen::Isometry3d> leftWaypoints, rightWaypoints;               // Cartesian waypoints for the hands
 			std::vector<double> times;                                                  // Time to reach each waypoint
 			Type type;                                                                  // Enumeration; relative or absolute
 			
 			// Find the left-hand motion in the list
-			auto temp = this->leftHandMap->find(actionName);
+			auto temp = actions->source.left.find(actionName);
 			
-			if(temp == this->leftHandMap->end())
+			if(temp == actions->source.left.end())
 			{
 				std::cerr << errorMessage << " move_hands_by_action(): "
 				          << "Could not find the action named '" << actionName
@@ -80,9 +243,9 @@ class CommandServer : public CommandInterface
 			}
 			
 			// Find the right-hand motion in the list
-			temp = this->rightHandMap->find(actionName);
+			temp = actions->source.right.find(actionName);
 			
-			if(temp == this->rightHandMap->end())
+			if(temp == actions->source.right.end())
 			{
 				std::cerr << errorMessage << " move_hands_by_action(): "
 				          << "Could not find the action named '" << actionName
@@ -147,9 +310,16 @@ class CommandServer : public CommandInterface
 				return false;
 			}
 			
-			auto temp = graspActionMap->find(actionName);                               // Temporary placeholder for the iterator
+			std::shared_ptr<const ActionStore> actions = std::atomic_load(&this->actions);
 			
-			if(temp == graspActionMap->end())
+			if(const CompiledAction *action = actions->graspActions.find(actionName))
+			{
+				return this->robot->move_object(action->first);                     // Already solved
+			}
+			
+			auto temp = actions->source.grasp.find(actionName);                         // Temporary placeholder for the iterator
+			
+			if(temp == actions->source.grasp.end())
 			{
 				std::cerr << errorMessage << "perform_grasp_action(): "
 				          << "Could not find the action named '"
@@ -206,9 +376,16 @@ class CommandServer : public CommandInterface
 				return false;
 			}
 			
-			auto jointConfig = this->jointActionMap->find(actionName);
+			std::shared_ptr<const ActionStore> actions = std::atomic_load(&this->actions);
+			
+			if(const CompiledAction *action = actions->jointActions.find(actionName))
+			{
+				return this->robot->move_to_positions(action->first);                   // Already solved
+			}
+			
+			auto jointConfig = actions->source.joint.find(actionName);
 			
-			if(jointConfig == this->jointActionMap->end())
+			if(jointConfig == actions->source.joint.end())
 			{
 				std::cerr << errorMessage << " move_to_named_configuration(): "
 				          << "Could not find a joint configuration named '"
@@ -306,11 +483,49 @@ class CommandServer : public CommandInterface
 		}
 
 		bool release_object() { return this->robot->release_object(); }
+		
+		bool start_streaming() { return this->robot->start_streaming(); }
 
 		void stop() { this->robot->halt(); }
 		
 		void shut_down() { this->serverActive = false; }	
 		
+		// Load the actions & gains from the config files again, without stopping the robot
+		bool reload_config()
+		{
+			yarp::os::Property parameter;
+			
+			if(not parameter.fromConfigFile(this->pathToConfig))
+			{
+				std::cerr << errorMessage << "reload_config(): Could not read " << this->pathToConfig << ".\n";
+				
+				return false;
+			}
+			
+			// Parsed & solved in this thread, so the control loop carries on as normal
+			std::shared_ptr<const ActionStore> newActions = load_action_store(*this->robot, parameter, this->pathToConfig);
+			
+			if(newActions == nullptr)
+			{
+				std::cerr << errorMessage << "reload_config(): Keeping the previous actions.\n";
+				
+				return false;
+			}
+			
+			if(not load_gains(*this->robot, parameter))
+			{
+				std::cerr << errorMessage << "reload_config(): Keeping the previous gains & actions.\n";
+				
+				return false;
+			}
+			
+			std::atomic_store(&this->actions, newActions);                              // Actions already running are unaffected
+			
+			std::cout << "[INFO] [iCUB COMMAND SERVER] Reloaded " << this->pathToConfig << ".\n";
+			
+			return true;
+		}
+		
 		///////////////////// Not defined in CommandInterface.h ///////////////////////////
 		bool is_active() const { return this->serverActive; }
 	    
@@ -319,9 +534,9 @@ class CommandServer : public CommandInterface
 		
 		PositionControl *robot;                                                             // Pointer to robot object
 		
-		std::map<std::string, JointTrajectory> *jointActionMap;                             // Map of prescribed joint configurations
-
-		std::map<std::string, CartesianMotion> *leftHandMap, *rightHandMap, *graspActionMap;
+		std::string pathToConfig;                                                           // Read again by reload_config()
+		
+		std::shared_ptr<const ActionStore> actions;                                         // Swapped atomically by reload_config()
 };                                                                                                  // Semicolon needed after class declaration
 
   ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -368,87 +583,42 @@ int main(int argc, char* argv[])
 		
 		std::vector<std::string> jointNames = string_from_bottle(bottle);                   // Function specified in Utils.h
 
-		// Load the joint-space actions from the config file
-		std::map<std::string, JointTrajectory> jointActionMap;                              // NOTE: JointTrajectory is a data structure in Utils.H
+		// Choose whether to control the robot or simulate the motors
+		JointInterface::Backend backend = JointInterface::Backend::yarp;
+		SimulationParameters simulation;
 		
-		bottle->clear(); bottle = &parameter.findGroup("JOINT_SPACE_ACTIONS");
+		std::string backendName = parameter.findGroup("JOINT_INTERFACE").check("backend", yarp::os::Value("yarp")).asString();
 		
-		if(bottle == nullptr)
+		if(backendName == "simulation")
 		{
-			std::cerr << errorMessage << "No group called JOINT_SPACE_ACTIONS could be found in "
-			          << pathToConfig << ".\n";
+			backend = JointInterface::Backend::simulation;
 			
-			return 1;
-		}
-		if(not load_joint_configurations(bottle,jointActionMap)) return 1;
-		
-		// Load the left hand actions from the config file
-		
-		bottle->clear(); bottle = parameter.findGroup("CARTESIAN_ACTIONS").find("names").asList(); // Find all the listed names
-		
-		std::vector<std::string> nameList = string_from_bottle(bottle);                            // Convert to vector of strings
-		
-		std::map<std::string, CartesianMotion> leftHandMap;                                        // Create the map so we can search it later
-		
-		bottle->clear(); bottle = parameter.findGroup("CARTESIAN_ACTIONS").find("left").asList();  // Get all the actions listed for the left hand
-		
-		if(bottle == nullptr)
-		{
-			std::cerr << errorMessage << "No list called 'left' in the CARTESIAN_ACTIONS group "
-			                          << "could be found in " << pathToConfig << ".\n";
-			return 1;
+			yarp::os::Bottle *start = parameter.find("desired_position").asList();
+			
+			if(start != nullptr) simulation.initialPosition = vector_from_bottle(start);       // Start somewhere sensible
+			
+			if(not load_simulation_parameters(&parameter.findGroup("SIMULATION"), simulation)) return 1;
 		}
-		
-		if(not load_cartesian_trajectories(bottle,nameList,leftHandMap)) return 1;                 // Try and put the named actions together in the map
-		
-		// Load the right hand actions from the config file
-		std::map<std::string, CartesianMotion> rightHandMap;
-		
-		bottle->clear(); bottle = parameter.findGroup("CARTESIAN_ACTIONS").find("right").asList(); // Find all the right hand actions
-		
-		if(bottle == nullptr)
+		else if(backendName != "yarp")
 		{
-			std::cerr << errorMessage << "No list called 'right' in the CARTESIAN_ACTIONS group "
-			                          << "could be found in " << pathToConfig << ".\n";
+			std::cerr << errorMessage << "Backend must be 'yarp' or 'simulation', but "
+			                          << pathToConfig << " specified '" << backendName << "'.\n";
 			return 1;
 		}
 		
-		if(not load_cartesian_trajectories(bottle,nameList,rightHandMap)) return 1;                // Put them in to the map
-		
-		
-		// Load the grasp actions from the config file
-		std::map<std::string, CartesianMotion> graspActionMap;                                     // Create map object
-		
-		bottle->clear(); bottle = &parameter.findGroup("GRASP_ACTIONS");                           // Find grasp actions in config file
+		PositionControl robot(pathToURDF, jointNames, portList, robotModel, backend, simulation); // Start up the robot
 		
-		if(bottle == nullptr)
-		{
-			std::cerr << errorMessage << "Could not find the the group called GRASP_ACTIONS "
-			                          << " in " << pathToConfig << ".\n";
-			return 1;
-		}
+		// Set the control frequency
+		double frequency = parameter.findGroup("CONTROL_LOOP").check("frequency", yarp::os::Value(100.0)).asFloat64();
+		if(not robot.set_control_frequency(frequency)) return 1;
 		
-		nameList = string_from_bottle(bottle->find("names").asList());                             // Get all the names
+		// Set the scheduling options for the control thread
+		RealTimeOptions realTimeOptions;
+		if(not load_real_time_options(&parameter.findGroup("REAL_TIME"), realTimeOptions)
+		or not robot.set_real_time_options(realTimeOptions)) return 1;
 		
-		if(not load_cartesian_trajectories(bottle,nameList,graspActionMap)) return 1;              // Load actions in to map
-	
-		
-		PositionControl robot(pathToURDF, jointNames, portList, robotModel);                // Start up the robot
-		
-		// Set the Cartesian gains
-		double kp = parameter.findGroup("CARTESIAN_GAINS").find("proportional").asFloat64();
-		double kd = parameter.findGroup("CARTESIAN_GAINS").find("derivative").asFloat64();	
-		if(not robot.set_cartesian_gains(kp,kd)) return 1;
-		
-		// Set the joint gains
-		kp = parameter.findGroup("JOINT_GAINS").find("proportional").asFloat64();
-		kd = parameter.findGroup("JOINT_GAINS").find("derivative").asFloat64();
-		if(not robot.set_joint_gains(kp,kd)) return 1;
-		
-		// Set the singularity avoidance parameters
-		double maxDamping = parameter.findGroup("SINGULARITY_AVOIDANCE").find("maxDamping").asFloat64();
-		double threshold  = parameter.findGroup("SINGULARITY_AVOIDANCE").find("threshold").asFloat64();
-		if(not robot.set_singularity_avoidance_params(maxDamping,threshold)) return 1;
+		// Set the gains, which can be changed later with reload_config()
+		if(not load_gains(robot, parameter)) return 1;
 		
 		// Set the desired position for the joints when running in Cartesian mode
 		bottle->clear(); bottle = parameter.find("desired_position").asList();
@@ -460,15 +630,22 @@ int main(int argc, char* argv[])
 		}
 		robot.set_desired_joint_position(vector_from_bottle(bottle));
 		
+		// Load the actions, and solve the absolute ones now so performing them doesn't have to
+		std::shared_ptr<const ActionStore> actions = load_action_store(robot, parameter, pathToConfig);
+		
+		if(actions == nullptr) return 1;
+		
+		// Check hand targets against a map made by reachability_builder
+		yarp::os::Bottle *reach = &parameter.findGroup("REACHABILITY");
+		
+		if(reach->check("map_file")
+		and not robot.set_reachability_map(beside_config(pathToConfig, reach->find("map_file").asString()),
+		                                   reach->check("max_adjustment", yarp::os::Value(0.0)).asFloat64())) return 1;
 		
 		// Establish communication over YARP
 		yarp::os::Network yarp;
 		yarp::os::Port port;
-		CommandServer commandServer(&robot,
-		                            &jointActionMap,
-		                            &leftHandMap,
-		                            &rightHandMap,
-		                            &graspActionMap);  // Create command server
+		CommandServer commandServer(&robot, pathToConfig, actions);                         // Create command server
 		                            
 		commandServer.yarp().attachAsServer(port);
 		
@@ -478,6 +655,25 @@ int main(int argc, char* argv[])
 			return 1;
 		}
 		
+		// Hand or object poses streamed from another module
+		double streamDelay = parameter.findGroup("STREAMING").check("delay", yarp::os::Value(0.02)).asFloat64();
+		
+		if(not robot.open_setpoint_stream(serverPortName + "/setpoints", streamDelay)) return 1;
+		
+		// Joint, hand or object targets at a high rate, on their own thread so they don't wait behind RPCs
+		TargetStream targetStream(&robot);
+		
+		if(not targetStream.open(serverPortName + "/targets")) return 1;
+		
+		// Publish the control loop timing once a second
+		TimingPublisher timingPublisher(&robot.loop_timer());
+		
+		if(not timingPublisher.open(serverPortName + "/timing") or not timingPublisher.start())
+		{
+			std::cerr << errorMessage << "Could not start publishing on " << serverPortName << "/timing.\n";
+			return 1;
+		}
+		
 		while(commandServer.is_active())
 		{
 			std::cout << "\nWorker bees can leave.\n";
@@ -490,6 +686,12 @@ int main(int argc, char* argv[])
 		
 		std::cout << "[INFO] [iCUB COMMAND SERVER] Shutting down. Arrivederci.\n";
 		
+		timingPublisher.stop();
+		
+		robot.close_setpoint_stream();
+		
+		targetStream.close();
+		
 		port.close();
 		
 		robot.close();
@@ -4,89 +4,123 @@
  //                                       Constructor                                              //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 JointInterface::JointInterface(const std::vector<std::string> &jointList,
-                               const std::vector<std::string> &portList)
+                               const std::vector<std::string> &portList,
+                               const Backend                  &_backend,
+                               const SimulationParameters     &simulation)
                                :
-                               numJoints(jointList.size())                                          // Number of joints equal to size of list
+                               numJoints(jointList.size()),                                         // Number of joints equal to size of list
+                               backend(_backend)                                                    // Real robot or simulation
 {
 	// Resize std::vector objects based on number of joints in the model
 	this->positionLimit.resize(this->numJoints);
 	this->velocityLimit.resize(this->numJoints);
+	this->positionBuffer.resize(this->numJoints);
+	this->velocityBuffer.resize(this->numJoints);
+	this->timeBuffer.resize(this->numJoints);
+	this->commandBuffer.resize(this->numJoints);
+	
+	std::string errorMessage = "[ERROR] [JOINT INTERFACE] Constructor: ";
+	
+	auto start = std::chrono::steady_clock::now();                                              // Time each stage of the bring-up
+	auto opened = start, configured = start;
+	
+	if(this->backend == Backend::simulation)
+	{
+		if(not this->simulator.open(this->numJoints, simulation)) throw std::runtime_error(errorMessage + "Could not start the simulated motors.");
+		
+		this->positionLimit = this->simulator.position_limits();
+		this->velocityLimit = this->simulator.velocity_limits();
+	}
+	else
+	{
+		////////////////////////// I copied this code from elsewhere ///////////////////////////////
 
-	////////////////////////// I copied this code from elsewhere ///////////////////////////////
-
-	// Open up device drivers
-	yarp::os::Property options;
-	options.put("device", "remotecontrolboardremapper");
-	options.addGroup("axesNames");
-
-	yarp::os::Bottle & bottle = options.findGroup("axesNames").addList();
-	for(int i = 0; i < jointList.size(); i++) bottle.addString(jointList[i].c_str());           // Add the list of all the joint names
+		// Open up device drivers
+		yarp::os::Property options;
+		options.put("device", "remotecontrolboardremapper");
+		options.addGroup("axesNames");
 
-	yarp::os::Bottle remoteControlBoards;
-	yarp::os::Bottle & remoteControlBoardsList = remoteControlBoards.addList();
-	for(int i = 0; i < portList.size(); i++) remoteControlBoardsList.addString(portList[i]);    // Add the remote control board port names
+		yarp::os::Bottle & bottle = options.findGroup("axesNames").addList();
+		for(int i = 0; i < jointList.size(); i++) bottle.addString(jointList[i].c_str());           // Add the list of all the joint names
 
-	options.put("remoteControlBoards", remoteControlBoards.get(0));
-	options.put("localPortPrefix", "/local");
+		yarp::os::Bottle remoteControlBoards;
+		yarp::os::Bottle & remoteControlBoardsList = remoteControlBoards.addList();
+		for(int i = 0; i < portList.size(); i++) remoteControlBoardsList.addString(portList[i]);    // Add the remote control board port names
 
-	yarp::os::Property &remoteControlBoardsOpts = options.addGroup("REMOTE_CONTROLBOARD_OPTIONS");
-			    remoteControlBoardsOpts.put("writeStrict", "on");
+		options.put("remoteControlBoards", remoteControlBoards.get(0));
+		options.put("localPortPrefix", "/local");
 
-	////////////////////////////////////////////////////////////////////////////////////////////
-	
-	std::string errorMessage = "[ERROR] [JOINT INTERFACE] Constructor: ";
+		yarp::os::Property &remoteControlBoardsOpts = options.addGroup("REMOTE_CONTROLBOARD_OPTIONS");
+				    remoteControlBoardsOpts.put("writeStrict", "on");
 
-	if(not this->driver.open(options)) throw std::runtime_error(errorMessage + "Could not open the device driver.");
-	else
-	{
+		////////////////////////////////////////////////////////////////////////////////////////////
+		
+		if(not this->driver.open(options)) throw std::runtime_error(errorMessage + "Could not open the device driver.");
+		
+		opened = std::chrono::steady_clock::now();
+		
 		     if(not this->driver.view(this->pController)) throw std::runtime_error(errorMessage + "Unable to configure the position controller for the joint motors.");
 		else if(not this->driver.view(this->mode))        throw std::runtime_error(errorMessage + "Unable to configure the control mode.");
 		else if(not this->driver.view(this->limits))      throw std::runtime_error(errorMessage + "Unable to obtain the joint limits.");
-		else
+		else if(not this->driver.view(this->encoders))    throw std::runtime_error(errorMessage + "Unable to configure the encoders.");
+		
+		// Opened the motor controllers, so get the joint limits. IControlLimits only has calls for
+		// one joint at a time, so these are still a round trip each
+		for(int i = 0; i < this->numJoints; i++)
 		{
-			// Opened the motor controllers, so get the joint limits
-			for(int i = 0; i < this->numJoints; i++)
-			{
-				double notUsed;
-				this->limits->getLimits(i, &this->positionLimit[i][0], &this->positionLimit[i][1]);
-				this->limits->getVelLimits(i, &notUsed, &this->velocityLimit[i]);   // Assume vMin = -vMax
-				
-				// Convert from degrees to radians
-				this->positionLimit[i][0] *= M_PI/180.0;
-				this->positionLimit[i][1] *= M_PI/180.0;
-				this->velocityLimit[i]    *= M_PI/180.0;
-				
-				if(not this->mode->setControlMode(i,VOCAB_CM_POSITION_DIRECT))
-				{
-					errorMessage += "Unable to set the control mode for joint " + std::to_string(i) + ".";
-					
-					throw std::runtime_error(errorMessage);
-				}
-			}
+			double notUsed;
+			this->limits->getLimits(i, &this->positionLimit[i][0], &this->positionLimit[i][1]);
+			this->limits->getVelLimits(i, &notUsed, &this->velocityLimit[i]);                   // Assume vMin = -vMax
 			
-			// Finally, configure the encoders
-			if(not this->driver.view(this->encoders)) throw std::runtime_error(errorMessage + "Unable to configure the encoders.");
-			else
-			{
-				double temp[this->numJoints];                                       // Temporary placeholder for encoder values			
-
-				// Make 5 attempts to read the encoders
-				for(int i = 0; i < 5; i++)
-				{
-					if(not this->encoders->getEncoders(temp) and i == 4)
-					{
-						throw std::runtime_error(errorMessage + "Could not obtain encoder values in 5 attempts.");
-					}
-				}
-				
-				std::cout << "[INFO] [JOINT INTERFACE] Successfully configured the joint motors.\n";
-			}
+			// Convert from degrees to radians
+			this->positionLimit[i][0] *= M_PI/180.0;
+			this->positionLimit[i][1] *= M_PI/180.0;
+			this->velocityLimit[i]    *= M_PI/180.0;
 		}
+		
+		// Set the control mode of every joint in one call, which the remapper splits by control board
+		std::vector<int> modes(this->numJoints, VOCAB_CM_POSITION_DIRECT);
+		
+		if(not this->mode->setControlModes(modes.data()))
+		{
+			throw std::runtime_error(errorMessage + "Unable to set the control mode for the joints.");
+		}
+		
+		configured = std::chrono::steady_clock::now();
+	}
+	
+	JointState initialState;
+	initialState.position.resize(this->numJoints);
+	initialState.velocity.resize(this->numJoints);
+	
+	// Make 5 attempts to read the encoders
+	for(int i = 0; i < 5; i++)
+	{
+		if(read_hardware(initialState)) break;
+		else if(i == 4) throw std::runtime_error(errorMessage + "Could not obtain encoder values in 5 attempts.");
+	}
+	
+	this->jointState.fill(initialState);                                                        // So the control loop has something to start with
+	
+	if(not this->encoderThread.start()) throw std::runtime_error(errorMessage + "Unable to start the encoder thread.");
+	
+	auto finished = std::chrono::steady_clock::now();
+	
+	std::cout << "[INFO] [JOINT INTERFACE] Successfully configured the joint motors in "
+	          << std::chrono::duration<double>(finished - start).count() << " s";
+	
+	if(this->backend == Backend::yarp)
+	{
+		std::cout << " (opening the driver " << std::chrono::duration<double>(opened - start).count()
+		          << " s, limits & control modes " << std::chrono::duration<double>(configured - opened).count()
+		          << " s, first encoder reading " << std::chrono::duration<double>(finished - configured).count() << " s)";
 	}
+	
+	std::cout << ".\n";
 }
 
   ////////////////////////////////////////////////////////////////////////////////////////////////////
- //                    Read the joint positions and velocities from the encoders                   //
+ //                    Get the latest joint positions and velocities from the encoders             //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 bool JointInterface::read_encoders(Eigen::VectorXd &pos, Eigen::VectorXd &vel)
 {
@@ -101,28 +135,108 @@ bool JointInterface::read_encoders(Eigen::VectorXd &pos, Eigen::VectorXd &vel)
 	}
 	else
 	{
-		bool success = true;
+		this->jointState.update();                                                          // Take the newest sample, if there is one
 		
-		for(int i = 0; i < this->numJoints; i++)
+		const JointState &latest = this->jointState.read_buffer();
+		
+		if(yarp::os::Time::now() - latest.receiveTime > this->encoderTimeout)
 		{
-			success &= this->encoders->getEncoder     (i, &pos(i));                     // Read joint positions
-			success &= this->encoders->getEncoderSpeed(i, &vel(i));                     // Read joint velocities
+			if(not this->stateStale)                                                    // Called every control step, so only say so once
+			{
+				std::cerr << "[ERROR] [JOINT INTERFACE] read_encoders(): "
+				          << "No new encoder values in the last " << this->encoderTimeout << " seconds.\n";
+				
+				this->stateStale = true;
+			}
+			
+			return false;
 		}
-		
-		if(success)
+		else
 		{
-			pos *= M_PI/180.0;                                                          // Convert to radians
-			vel *= M_PI/180.0;                                                          // Convert to radians
+			if(this->stateStale)
+			{
+				std::cout << "[INFO] [JOINT INTERFACE] read_encoders(): New encoder values are arriving again.\n";
+				
+				this->stateStale = false;
+			}
+			
+			pos = latest.position;
+			vel = latest.velocity;
+			
+			this->encoderTime = latest.time;
+			this->receiveTime = latest.receiveTime;
 			
 			return true;
 		}
-		else
+	}
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                       Time between sampling the encoders and the given time                    //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+double JointInterface::sensing_delay(const double &now) const
+{
+	double delay = now - this->encoderTime;
+	
+	// If the robot clock isn't synced with ours (e.g. Gazebo sim time) the time stamp
+	// is meaningless here, so fall back to when the reading was received
+	if(delay < 0 or delay > this->encoderTimeout) delay = now - this->receiveTime;
+	
+	return std::max(delay, 0.0);
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                        Read all the encoders directly from the control boards                  //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool JointInterface::read_hardware(JointState &state)
+{
+	if(this->backend == Backend::simulation)
+	{
+		state.receiveTime = yarp::os::Time::now();
+		
+		return this->simulator.read(state.position, state.velocity, state.time);
+	}
+	
+	// Read all the joints in one call per control board rather than one call per joint
+	if(not this->encoders->getEncodersTimed(this->positionBuffer.data(), this->timeBuffer.data())
+	or not this->encoders->getEncoderSpeeds(this->velocityBuffer.data()))
+	{
+		return false;
+	}
+	else
+	{
+		state.receiveTime = yarp::os::Time::now();
+		state.time        = this->timeBuffer[0];
+		
+		for(int i = 0; i < this->numJoints; i++)
 		{
-			std::cerr << "[ERROR] [JOINT INTERFACE] read_encoders(): "
-			             "Could not obtain new encoder values.\n";
+			state.position(i) = this->positionBuffer[i]*M_PI/180.0;                     // Convert to radians
+			state.velocity(i) = this->velocityBuffer[i]*M_PI/180.0;                     // Convert to radians
 			
-			return false;
+			if(this->timeBuffer[i] < state.time) state.time = this->timeBuffer[i];      // State is only as new as the oldest board
 		}
+		
+		return true;
+	}
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                       Read the encoders and publish the result (own thread)                    //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void JointInterface::acquire_joint_state()
+{
+	if(read_hardware(this->jointState.write_buffer()))
+	{
+		this->jointState.publish();                                                         // Hand over to the control loop
+		
+		this->readFailed = false;
+	}
+	else if(not this->readFailed)
+	{
+		std::cerr << "[ERROR] [JOINT INTERFACE] acquire_joint_state(): "
+		             "Could not obtain new encoder values.\n";
+		
+		this->readFailed = true;
 	}
 }
 
@@ -133,7 +247,7 @@ bool JointInterface::send_joint_commands(const Eigen::VectorXd &commands)
 {
 	if(commands.size() != this->numJoints)
 	{
-		std::cerr << "[ERROR] [JOINT INTERFACE] send_joint_command(): "
+		std::cerr << "[ERROR] [JOINT INTERFACE] send_joint_commands(): "
 		          << "This robot has " << this->numJoints << " active joints but the input "
 		          << "argument had " << commands.size() << " elements.\n";
 		          
@@ -141,18 +255,32 @@ bool JointInterface::send_joint_commands(const Eigen::VectorXd &commands)
 	}
 	else
 	{
+		// Check the whole vector before sending anything so the motors never get half a command
 		for(int i = 0; i < this->numJoints; i++)
 		{
-			if(not this->pController->setPosition(i,commands[i]*180.0/M_PI))
+			if(not std::isfinite(commands[i]))
 			{
 				std::cerr << "[ERROR] [JOINT INTERFACE] send_joint_commands(): "
-				          << "Could not send a command for joint " << i << ".\n";
+				          << "Command for joint " << i << " is " << commands[i] << ". "
+				          << "No commands were sent.\n";
 				
 				return false;
 			}
+			
+			this->commandBuffer[i] = commands[i]*180.0/M_PI;                            // Convert to degrees
 		}
 		
-		return true;
+		if(this->backend == Backend::simulation) return this->simulator.write(commands);
+		
+		// One message per control board, so all the joints are updated together
+		if(not this->pController->setPositions(this->commandBuffer.data()))
+		{
+			std::cerr << "[ERROR] [JOINT INTERFACE] send_joint_commands(): "
+			          << "Could not send the joint commands.\n";
+			
+			return false;
+		}
+		else return true;
 	}
 }
 
@@ -161,6 +289,19 @@ bool JointInterface::send_joint_commands(const Eigen::VectorXd &commands)
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 void JointInterface::close()
 {
+	if(this->closed) return;                                                                    // Already done
+	
+	this->closed = true;
+	
+	this->encoderThread.stop();                                                                 // Stop reading the encoders
+	
+	if(this->backend == Backend::simulation)
+	{
+		this->simulator.close();
+		
+		return;
+	}
+	
 	for(int i = 0; i < this->numJoints; i++) this->mode->setControlMode(i, VOCAB_CM_POSITION);  // Set in position mode to lock the joint
 	
 	this->driver.close();                                                                       // Close the device drivers
@@ -0,0 +1,108 @@
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+   //                                                                                                //
+  //         Measures the jitter of a periodic thread with & without the real-time options          //
+ //                                                                                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <Eigen/Dense>                                                                              // Eigen::MatrixXd, Eigen::LDLT
+#include <iostream>                                                                                 // std::cout, std::cerr
+#include <LoopTimer.h>                                                                              // Jitter histograms
+#include <RealTime.h>                                                                               // Scheduling options
+#include <string>                                                                                   // std::stoi, std::stod
+#include <yarp/os/Network.h>                                                                        // yarp::os::Network
+#include <yarp/os/PeriodicThread.h>                                                                 // yarp::os::PeriodicThread
+#include <yarp/os/Time.h>                                                                           // yarp::os::Time::delay()
+
+// Does about as much linear algebra per step as the Cartesian controller
+class BenchmarkThread : public yarp::os::PeriodicThread
+{
+	public:
+		BenchmarkThread(const double &period, const RealTimeOptions &_options)
+		:
+		yarp::os::PeriodicThread(period),
+		options(_options),
+		A(Eigen::MatrixXd::Random(17,17)),
+		b(Eigen::VectorXd::Random(17)) {}
+
+		bool threadInit() { configure_current_thread(this->options); return true; }
+
+		void run()
+		{
+			this->timer.start_tick();
+
+			Eigen::MatrixXd H = this->A.transpose()*this->A + Eigen::MatrixXd::Identity(17,17);
+
+			this->timer.end_stage(LoopTimer::reference);
+
+			this->x = H.ldlt().solve(this->b);
+
+			this->timer.end_stage(LoopTimer::solve);
+
+			this->timer.end_tick(getPeriod());
+		}
+
+		const LoopTimer& loop_timer() const { return this->timer; }
+
+	private:
+
+		RealTimeOptions options;
+
+		LoopTimer timer;
+
+		Eigen::MatrixXd A;
+
+		Eigen::VectorXd b, x;
+};
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                   Run the thread for a while                                   //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void run_benchmark(const std::string &title, const double &frequency, const double &duration, const RealTimeOptions &options)
+{
+	BenchmarkThread thread(1.0/frequency, options);
+
+	if(not thread.start())
+	{
+		std::cerr << "[ERROR] [LOOP BENCHMARK] Could not start the thread.\n";
+		return;
+	}
+
+	yarp::os::Time::delay(duration);
+
+	thread.stop();
+
+	std::cout << "\n" << title << "\n" << thread.loop_timer().report();
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                             MAIN                                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+	if(argc != 5)
+	{
+		std::cerr << "[ERROR] [LOOP BENCHMARK] Frequency, duration, priority and CPU are required. "
+		          << "Usage: ./loop_benchmark 500 30 80 3\n";
+
+		return 1;
+	}
+
+	double frequency = std::stod(argv[1]);                                                      // Hz
+	double duration  = std::stod(argv[2]);                                                      // Seconds for each run
+
+	RealTimeOptions realTime;
+	realTime.priority   = std::stoi(argv[3]);
+	realTime.cpu        = std::stoi(argv[4]);
+	realTime.lockMemory = true;
+
+	yarp::os::Network yarp;
+
+	run_benchmark("Default scheduling:", frequency, duration, RealTimeOptions());
+
+	if(not lock_process_memory()) std::cerr << "[WARNING] [LOOP BENCHMARK] Running without locked memory.\n";
+
+	run_benchmark("SCHED_FIFO priority " + std::to_string(realTime.priority)
+	            + ", CPU " + std::to_string(realTime.cpu) + ", locked memory:", frequency, duration, realTime);
+
+	return 0;
+}
@@ -0,0 +1,194 @@
+#include <LoopTimer.h>
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                   Add a sample to the histogram                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void TimingHistogram::record(const double &seconds)
+{
+	int bin = 0;                                                                                // Anything under 1 microsecond
+
+	if(seconds >= 1e-6) bin = std::min(numBins - 1, 1 + (int)(4*std::log2(seconds*1e6)));
+
+	this->bins[bin].fetch_add(1, std::memory_order_relaxed);
+
+	this->samples.fetch_add(1, std::memory_order_relaxed);
+
+	unsigned long nanoseconds = (unsigned long)(std::max(seconds, 0.0)*1e9);
+
+	unsigned long previous = this->maxNanoseconds.load(std::memory_order_relaxed);
+
+	while(nanoseconds > previous
+	and not this->maxNanoseconds.compare_exchange_weak(previous, nanoseconds, std::memory_order_relaxed));
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                     Clear all the samples                                      //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void TimingHistogram::reset()
+{
+	for(auto &bin : this->bins) bin.store(0, std::memory_order_relaxed);
+
+	this->samples.store(0, std::memory_order_relaxed);
+
+	this->maxNanoseconds.store(0, std::memory_order_relaxed);
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //              Get the time below which the given fraction of samples fall (approx.)             //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+double TimingHistogram::percentile(const double &fraction) const
+{
+	unsigned long total = count();
+
+	if(total == 0) return 0.0;
+
+	double target = fraction*total;
+
+	unsigned long cumulative = 0;
+
+	for(int i = 0; i < numBins; i++)
+	{
+		cumulative += this->bins[i].load(std::memory_order_relaxed);
+
+		if(cumulative >= target) return std::min(upper_edge(i), max());                     // Can't be any bigger than the max
+	}
+
+	return max();
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                    Start timing a control step                                 //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void LoopTimer::start_tick()
+{
+	this->tickStart = std::chrono::steady_clock::now();
+
+	if(this->lastTickStart == TimePoint()) this->interval = -1;                                 // First tick of this action
+	else this->interval = std::chrono::duration<double>(this->tickStart - this->lastTickStart).count();
+
+	this->lastTickStart = this->tickStart;
+
+	this->lastMark = this->tickStart;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                        Record the time taken since the previous stage ended                    //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void LoopTimer::end_stage(const Stage &stage)
+{
+	TimePoint now = std::chrono::steady_clock::now();
+
+	this->stages[stage].record(std::chrono::duration<double>(now - this->lastMark).count());
+
+	this->lastMark = now;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                         Record the total time & jitter for the control step                    //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void LoopTimer::end_tick(const double &period)
+{
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->tickStart).count();
+
+	this->stages[total].record(elapsed);
+
+	if(elapsed > period) this->overrunCount.fetch_add(1, std::memory_order_relaxed);
+
+	if(this->interval >= 0) this->jitterHistogram.record(std::abs(this->interval - period));
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                     Clear all the histograms                                   //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void LoopTimer::reset()
+{
+	for(auto &histogram : this->stages) histogram.reset();
+
+	this->jitterHistogram.reset();
+
+	this->overrunCount.store(0, std::memory_order_relaxed);
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                      Names used in the output                                  //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::string LoopTimer::stage_name(const Stage &stage)
+{
+	switch(stage)
+	{
+		case state:     return "state";
+		case reference: return "reference";
+		case solve:     return "solve";
+		case command:   return "command";
+		case total:     return "total";
+		default:        return "unknown";
+	}
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                            Put the statistics in a table (milliseconds)                        //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::string LoopTimer::report() const
+{
+	std::stringstream stream;
+
+	stream.precision(3);
+	stream << std::fixed;
+
+	stream << "stage        count      p50 (ms)   p99 (ms)   max (ms)\n";
+
+	auto add_row = [&stream](const std::string &name, const TimingHistogram &histogram)
+	{
+		stream.width(12); stream << std::left  << name << " ";
+		stream.width(10); stream << std::right << histogram.count()            << " ";
+		stream.width(10); stream << histogram.percentile(0.50)*1000 << " ";
+		stream.width(10); stream << histogram.percentile(0.99)*1000 << " ";
+		stream.width(10); stream << histogram.max()*1000 << "\n";
+	};
+
+	for(int i = 0; i < numStages; i++) add_row(stage_name((Stage)i), this->stages[i]);
+
+	add_row("jitter", this->jitterHistogram);
+
+	stream << "overruns: " << overruns() << "\n";
+
+	return stream.str();
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //             Put the statistics in a bottle: (name count p50 p99 max) ... (overruns n)          //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void LoopTimer::write(yarp::os::Bottle &bottle) const
+{
+	auto add_list = [&bottle](const std::string &name, const TimingHistogram &histogram)
+	{
+		yarp::os::Bottle &list = bottle.addList();
+		list.addString(name);
+		list.addInt64(histogram.count());
+		list.addFloat64(histogram.percentile(0.50)*1000);                                   // Convert to milliseconds
+		list.addFloat64(histogram.percentile(0.99)*1000);
+		list.addFloat64(histogram.max()*1000);
+	};
+
+	for(int i = 0; i < numStages; i++) add_list(stage_name((Stage)i), this->stages[i]);
+
+	add_list("jitter", this->jitterHistogram);
+
+	yarp::os::Bottle &list = bottle.addList();
+	list.addString("overruns");
+	list.addInt64(overruns());
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                   Send the latest statistics                                   //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void TimingPublisher::run()
+{
+	yarp::os::Bottle &bottle = this->port.prepare();
+
+	bottle.clear();
+
+	this->timer->write(bottle);
+
+	this->port.write();
+}
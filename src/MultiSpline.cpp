@@ -0,0 +1,593 @@
+#include <MultiSpline.h>
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                         Constructor                                            //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+MultiSpline::MultiSpline(const Eigen::MatrixXd     &points,
+                         const std::vector<double> &times,
+                         const Eigen::VectorXd     &startVelocity,
+                         const Eigen::VectorXd     &startAcceleration)
+{
+	// Check that the inputs are sound
+	std::string errorMessage = "[ERROR] [MULTI SPLINE] Constructor: ";
+
+	if(points.cols() != times.size())
+	{
+		errorMessage += "Points had " + std::to_string(points.cols()) + " columns, and the "
+		                "time vector had " + std::to_string(times.size()) + " elements.";
+
+		throw std::invalid_argument(errorMessage);
+	}
+	else if(times.size() < 2)
+	{
+		errorMessage += "A minimum of 2 points is needed to create a spline.";
+
+		throw std::invalid_argument(errorMessage);
+	}
+	else if(startVelocity.size() != points.rows())
+	{
+		errorMessage += "Points had " + std::to_string(points.rows()) + " rows, but the start "
+		                "velocity had " + std::to_string(startVelocity.size()) + " elements.";
+
+		throw std::invalid_argument(errorMessage);
+	}
+	else if(startAcceleration.size() != points.rows())
+	{
+		errorMessage += "Points had " + std::to_string(points.rows()) + " rows, but the start "
+		                "acceleration had " + std::to_string(startAcceleration.size()) + " elements.";
+
+		throw std::invalid_argument(errorMessage);
+	}
+
+	for(int i = 1; i < times.size(); i++)
+	{
+		if(times[i] <= times[i-1])
+		{
+			errorMessage += "Times must be increasing, but time " + std::to_string(i) + " ("
+			              + std::to_string(times[i]) + " s) was not after time " + std::to_string(i-1)
+			              + " (" + std::to_string(times[i-1]) + " s).";
+
+			throw std::invalid_argument(errorMessage);
+		}
+	}
+
+	unsigned int n = times.size();                                                              // Number of knots
+	unsigned int m = points.rows();                                                             // Number of channels
+
+	// Three extra channels are solved alongside the real ones: a unit step in the start point,
+	// a unit start velocity, and a unit start acceleration. These are what set_start() scales
+	// and adds on later.
+	Eigen::MatrixXd y = Eigen::MatrixXd::Zero(m+3,n);
+	y.topRows(m) = points;
+	y(m,0)       = 1.0;
+
+	Eigen::VectorXd a0 = Eigen::VectorXd::Zero(m+3);                                            // Acceleration at the first knot
+	a0.head(m) = startAcceleration;
+	a0(m+2)    = 1.0;
+
+	// The velocity at the first knot is given, and it is zero at the last one. The knots in
+	// between have the velocities that make the acceleration continuous:
+	//
+	//     v(i-1)/h(i-1) + 2*(1/h(i-1) + 1/h(i))*v(i) + v(i+1)/h(i)
+	//          = 3*((y(i) - y(i-1))/h(i-1)^2 + (y(i+1) - y(i))/h(i)^2),     h(i) = t(i+1) - t(i)
+	//
+	// The first segment is a quartic that also starts with acceleration a0, so at the first
+	// interior knot this becomes
+	//
+	//     (3/h(0) + 2/h(1))*v(1) + v(2)/h(1)
+	//          = 6*(y(1) - y(0))/h(0)^2 + 3*(y(2) - y(1))/h(1)^2 - 3*v(0)/h(0) - a0/2
+	//
+	// The matrix only depends on the times, so it is eliminated once and applied to every channel.
+
+	Eigen::MatrixXd v = Eigen::MatrixXd::Zero(m+3,n);                                           // Velocity at each knot
+	v.col(0).head(m) = startVelocity;
+	v(m+1,0)         = 1.0;
+
+	std::vector<double> upper(n, 0.0);                                                          // Super-diagonal after elimination
+
+	for(int i = 1; i < n-1; i++)                                                                // Forward elimination
+	{
+		double a = 1/(times[i]   - times[i-1]);
+		double c = 1/(times[i+1] - times[i]);
+
+		if(i == 1)                                                                          // Next to the quartic
+		{
+			double pivot = 3*a + 2*c;
+
+			v.col(i) = (6*a*a*(y.col(1) - y.col(0)) + 3*c*c*(y.col(2) - y.col(1)) - 3*a*v.col(0) - 0.5*a0)/pivot;
+
+			upper[i] = c/pivot;
+		}
+		else
+		{
+			double pivot = 2*(a + c) - a*upper[i-1];
+
+			v.col(i) = (3*(a*a*(y.col(i) - y.col(i-1)) + c*c*(y.col(i+1) - y.col(i))) - a*v.col(i-1))/pivot;
+
+			upper[i] = c/pivot;
+		}
+	}
+
+	for(int i = n-3; i > 0; i--) v.col(i) -= upper[i]*v.col(i+1);                              // Back substitution
+
+	// Now the polynomial for each segment from the points & velocities either side
+	Eigen::MatrixXd c0(m+3,n-1), c1(m+3,n-1), c2(m+3,n-1), c3(m+3,n-1);
+	Eigen::MatrixXd c4 = Eigen::MatrixXd::Zero(m+3,n-1);
+
+	for(int k = 0; k < n-1; k++)
+	{
+		double h = times[k+1] - times[k];
+
+		c0.col(k) = y.col(k);
+		c1.col(k) = v.col(k);
+
+		if(k == 0)                                                                          // Quartic, starting with acceleration a0
+		{
+			Eigen::VectorXd D = y.col(1) - y.col(0) - h*v.col(0) - 0.5*h*h*a0;              // What the cubic & quartic terms must add
+			Eigen::VectorXd E = v.col(1) - v.col(0) - h*a0;                                 // And their rate
+
+			c2.col(k) = 0.5*a0;
+			c3.col(k) = (4*D - h*E)/(h*h*h);
+			c4.col(k) = (h*E - 3*D)/(h*h*h*h);
+		}
+		else
+		{
+			Eigen::VectorXd slope = (y.col(k+1) - y.col(k))/h;
+
+			c2.col(k) = (3*slope - 2*v.col(k) - v.col(k+1))/h;
+			c3.col(k) = (v.col(k) + v.col(k+1) - 2*slope)/(h*h);
+		}
+	}
+
+	std::shared_ptr<Coefficients> coefficients = std::make_shared<Coefficients>();
+
+	coefficients->times = times;
+
+	coefficients->c0 = c0.topRows(m);
+	coefficients->c1 = c1.topRows(m);
+	coefficients->c2 = c2.topRows(m);
+	coefficients->c3 = c3.topRows(m);
+	coefficients->c4 = c4.topRows(m);
+
+	coefficients->pointBasis.resize(5,n-1);
+	coefficients->pointBasis << c0.row(m), c1.row(m), c2.row(m), c3.row(m), c4.row(m);
+
+	coefficients->velocityBasis.resize(5,n-1);
+	coefficients->velocityBasis << c0.row(m+1), c1.row(m+1), c2.row(m+1), c3.row(m+1), c4.row(m+1);
+
+	coefficients->accelerationBasis.resize(5,n-1);
+	coefficients->accelerationBasis << c0.row(m+2), c1.row(m+2), c2.row(m+2), c3.row(m+2), c4.row(m+2);
+
+	coefficients->startPoint        = points.col(0);
+	coefficients->startVelocity     = startVelocity;
+	coefficients->startAcceleration = startAcceleration;
+	coefficients->endPoint          = points.col(n-1);
+
+	this->data = coefficients;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //            Start from a different point & velocity without solving the spline again            //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool MultiSpline::set_start(const Eigen::VectorXd &point, const Eigen::VectorXd &velocity)
+{
+	if(not this->data)
+	{
+		std::cerr << "[ERROR] [MULTI SPLINE] set_start(): This spline is empty.\n";
+
+		return false;
+	}
+
+	return set_start(point, velocity, this->data->startAcceleration);                          // Keep the acceleration it was built with
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //      Start from a different point, velocity & acceleration without solving the spline again    //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool MultiSpline::set_start(const Eigen::VectorXd &point,
+                            const Eigen::VectorXd &velocity,
+                            const Eigen::VectorXd &acceleration)
+{
+	if(point.size() != dimensions() or velocity.size() != dimensions() or acceleration.size() != dimensions())
+	{
+		std::cerr << "[ERROR] [MULTI SPLINE] set_start(): "
+		          << "This spline has " << dimensions() << " channels but the start point had "
+		          << point.size() << " elements, the start velocity had " << velocity.size()
+		          << ", and the start acceleration had " << acceleration.size() << ".\n";
+
+		return false;
+	}
+
+	this->pointShift        = point        - this->data->startPoint;
+	this->velocityShift     = velocity     - this->data->startVelocity;
+	this->accelerationShift = acceleration - this->data->startAcceleration;
+	this->cursor            = 0;
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                           Get the points the spline passes through                             //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::MatrixXd MultiSpline::waypoints() const
+{
+	if(not this->data) return Eigen::MatrixXd();
+
+	Eigen::MatrixXd points(dimensions(), this->data->times.size());
+	points.leftCols(points.cols()-1) = this->data->c0;
+	points.rightCols(1)              = this->data->endPoint;
+
+	if(this->pointShift.size() > 0) points.col(0) += this->pointShift;
+
+	return points;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //            Get the quickest times through the points that stay inside the limits               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::vector<double> MultiSpline::fastest_times(const Eigen::MatrixXd &points,
+                                               const Eigen::VectorXd &startVelocity,
+                                               const Eigen::VectorXd &maxVelocity,
+                                               const Eigen::VectorXd &maxAcceleration)
+{
+	if(points.cols() < 2
+	or maxVelocity.size()     != points.rows()
+	or maxAcceleration.size() != points.rows())
+	{
+		std::string errorMessage = "[ERROR] [MULTI SPLINE] fastest_times(): "
+		                           "Need at least 2 points, and a velocity & acceleration limit for "
+		                           "each of the " + std::to_string(points.rows()) + " channels.";
+
+		throw std::invalid_argument(errorMessage);
+	}
+
+	unsigned int n = points.cols();
+	unsigned int m = points.rows();
+
+	// Stretching can't slow down the start, so a channel already moving faster than its limit would
+	// stretch the first segment forever. Time it as if it were moving at the limit instead.
+	Eigen::VectorXd velocity = startVelocity;
+
+	for(int i = 0; i < m; i++)
+	{
+		if(maxVelocity(i) > 0) velocity(i) = std::max(-maxVelocity(i), std::min(velocity(i), maxVelocity(i)));
+	}
+
+	const Eigen::VectorXd boundedStart = velocity;
+
+	// Start each segment at the time a cubic from rest to rest would need. The peak speed of one
+	// of those is 1.5*distance/h and the peak acceleration is 6*distance/h^2. A limit that isn't
+	// positive is treated as no limit at all.
+	std::vector<double> duration(n-1, minimumDuration);
+
+	for(int k = 0; k < n-1; k++)
+	{
+		for(int i = 0; i < m; i++)
+		{
+			double distance = std::abs(points(i,k+1) - points(i,k));
+
+			if(maxVelocity(i)     > 0) duration[k] = std::max(duration[k], 1.5*distance/maxVelocity(i));
+			if(maxAcceleration(i) > 0) duration[k] = std::max(duration[k], sqrt(6*distance/maxAcceleration(i)));
+		}
+	}
+
+	// Passing through the waypoints without stopping changes the peaks, so check the actual spline
+	// and stretch any segment that breaks a limit. Slowing a segment by a factor s divides its
+	// speed by s and its acceleration by s^2.
+	std::vector<double> times(n, 0.0);
+
+	Eigen::VectorXd acceleration(m);
+
+	for(int iteration = 0; iteration < maxRetimingIterations; iteration++)
+	{
+		for(int k = 0; k < n-1; k++) times[k+1] = times[k] + duration[k];
+
+		MultiSpline spline(points, times, boundedStart);
+
+		bool withinLimits = true;
+
+		for(int k = 0; k < n-1; k++)
+		{
+			spline.peak_rates(k, velocity, acceleration);
+
+			double stretch = 1.0;
+
+			for(int i = 0; i < m; i++)
+			{
+				if(maxVelocity(i)     > 0) stretch = std::max(stretch, velocity(i)/maxVelocity(i));
+				if(maxAcceleration(i) > 0) stretch = std::max(stretch, sqrt(acceleration(i)/maxAcceleration(i)));
+			}
+
+			if(stretch > 1.0 + 1e-03)
+			{
+				duration[k] *= stretch;
+
+				withinLimits = false;
+			}
+		}
+
+		if(withinLimits) return times;
+	}
+
+	throw std::runtime_error("[ERROR] [MULTI SPLINE] fastest_times(): "
+	                         "Could not find times within the limits after "
+	                         + std::to_string(maxRetimingIterations) + " attempts.");
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //             Largest speed & acceleration of each channel over a segment of the spline           //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void MultiSpline::peak_rates(const unsigned int &k,
+                             Eigen::VectorXd &velocity,
+                             Eigen::VectorXd &acceleration) const
+{
+	const Coefficients &s = *this->data;                                                        // Only used before set_start()
+
+	double h = s.times[k+1] - s.times[k];
+
+	for(int i = 0; i < s.c0.rows(); i++)
+	{
+		double b = s.c1(i,k), c = s.c2(i,k), d = s.c3(i,k), e = s.c4(i,k);
+
+		auto speed = [&](const double &t) { return std::abs(b + t*(2*c + t*(3*d + 4*e*t))); };
+		auto accel = [&](const double &t) { return std::abs(2*c + t*(6*d + 12*e*t)); };
+
+		// Acceleration is at most quadratic, so the largest is at one of the ends or the turning point
+		acceleration(i) = std::max(accel(0), accel(h));
+
+		if(e != 0)
+		{
+			double dt = -d/(4*e);
+
+			if(dt > 0 and dt < h) acceleration(i) = std::max(acceleration(i), accel(dt));
+		}
+
+		// Speed is at most cubic, so check the ends and where the acceleration is zero
+		velocity(i) = std::max(speed(0), speed(h));
+
+		double roots[2];
+		int numRoots = 0;
+
+		if(e != 0)
+		{
+			double discriminant = 36*d*d - 96*c*e;
+
+			if(discriminant >= 0)
+			{
+				roots[numRoots++] = (-6*d + sqrt(discriminant))/(24*e);
+				roots[numRoots++] = (-6*d - sqrt(discriminant))/(24*e);
+			}
+		}
+		else if(d != 0) roots[numRoots++] = -c/(3*d);
+
+		for(int j = 0; j < numRoots; j++)
+		{
+			if(roots[j] > 0 and roots[j] < h) velocity(i) = std::max(velocity(i), speed(roots[j]));
+		}
+	}
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                              Find the segment the time falls in                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+unsigned int MultiSpline::segment(const double &time) const
+{
+	const std::vector<double> &times = this->data->times;
+
+	unsigned int last = times.size() - 2;                                                       // Index of the final segment
+
+	if(this->cursor > last or time < times[this->cursor])                                       // Went backwards, so search from scratch
+	{
+		int k = std::upper_bound(times.begin(), times.end(), time) - times.begin() - 1;
+
+		this->cursor = std::max(0, std::min(k, (int)last));                                 // Before the start is the first segment
+	}
+	else
+	{
+		while(this->cursor < last and time >= times[this->cursor+1]) this->cursor++;        // Walk forward
+	}
+
+	return this->cursor;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                             Get the position for the given time                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool MultiSpline::evaluate(const double &time, Eigen::Ref<Eigen::VectorXd> pos) const
+{
+	if(not this->data or pos.size() != dimensions())
+	{
+		std::cerr << "[ERROR] [MULTI SPLINE] evaluate(): "
+		          << "This spline has " << dimensions() << " channels but the output argument "
+		          << "had " << pos.size() << " elements.\n";
+
+		return false;
+	}
+
+	const Coefficients &s = *this->data;
+
+	if(time >= s.times.back())                                                                  // Finished, so stay at the end
+	{
+		pos = s.endPoint;
+
+		return true;
+	}
+
+	unsigned int k = segment(time);
+
+	double dt = std::max(time - s.times[k], 0.0);                                               // Hold the start before the first knot
+
+	pos = s.c0.col(k) + dt*(s.c1.col(k) + dt*(s.c2.col(k) + dt*(s.c3.col(k) + dt*s.c4.col(k))));
+
+	if(this->pointShift.size() > 0)                                                             // Started somewhere else
+	{
+		Eigen::Matrix<double,5,1> powers(1, dt, dt*dt, dt*dt*dt, dt*dt*dt*dt);
+
+		pos += powers.dot(s.pointBasis.col(k))*this->pointShift
+		     + powers.dot(s.velocityBasis.col(k))*this->velocityShift
+		     + powers.dot(s.accelerationBasis.col(k))*this->accelerationShift;
+	}
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                  Get the position, velocity and acceleration for the given time                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool MultiSpline::evaluate(const double                &time,
+                           Eigen::Ref<Eigen::VectorXd> pos,
+                           Eigen::Ref<Eigen::VectorXd> vel,
+                           Eigen::Ref<Eigen::VectorXd> acc) const
+{
+	if(not this->data
+	or pos.size() != dimensions()
+	or vel.size() != dimensions()
+	or acc.size() != dimensions())
+	{
+		std::cerr << "[ERROR] [MULTI SPLINE] evaluate(): "
+		          << "This spline has " << dimensions() << " channels but the output arguments "
+		          << "had " << pos.size() << ", " << vel.size() << " and " << acc.size() << " elements.\n";
+
+		return false;
+	}
+
+	const Coefficients &s = *this->data;
+
+	if(time >= s.times.back())
+	{
+		pos = s.endPoint;
+		vel.setZero();
+		acc.setZero();
+
+		return true;
+	}
+
+	unsigned int k = segment(time);
+
+	double dt = std::max(time - s.times[k], 0.0);
+
+	pos = s.c0.col(k) + dt*(s.c1.col(k) + dt*(s.c2.col(k) + dt*(s.c3.col(k) + dt*s.c4.col(k))));
+	vel = s.c1.col(k) + dt*(2*s.c2.col(k) + dt*(3*s.c3.col(k) + 4*dt*s.c4.col(k)));
+	acc = 2*s.c2.col(k) + dt*(6*s.c3.col(k) + 12*dt*s.c4.col(k));
+
+	if(this->pointShift.size() > 0)
+	{
+		Eigen::Matrix<double,5,1> powers(1, dt, dt*dt, dt*dt*dt, dt*dt*dt*dt);              // And their derivatives below
+		Eigen::Matrix<double,5,1> rates(0, 1, 2*dt, 3*dt*dt, 4*dt*dt*dt);
+		Eigen::Matrix<double,5,1> curvature(0, 0, 2, 6*dt, 12*dt*dt);
+
+		const auto &a = s.pointBasis.col(k);
+		const auto &b = s.velocityBasis.col(k);
+		const auto &c = s.accelerationBasis.col(k);
+
+		pos += powers.dot(a)*this->pointShift    + powers.dot(b)*this->velocityShift    + powers.dot(c)*this->accelerationShift;
+		vel += rates.dot(a)*this->pointShift     + rates.dot(b)*this->velocityShift     + rates.dot(c)*this->accelerationShift;
+		acc += curvature.dot(a)*this->pointShift + curvature.dot(b)*this->velocityShift + curvature.dot(c)*this->accelerationShift;
+	}
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                Get the position, velocity and acceleration for many times in one call          //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool MultiSpline::sample(const std::vector<double>   &times,
+                         Eigen::Ref<Eigen::MatrixXd> pos,
+                         Eigen::Ref<Eigen::MatrixXd> vel,
+                         Eigen::Ref<Eigen::MatrixXd> acc) const
+{
+	const unsigned int n = times.size();
+
+	if(not this->data
+	or pos.rows() != dimensions() or vel.rows() != dimensions() or acc.rows() != dimensions()
+	or pos.cols() != n            or vel.cols() != n            or acc.cols() != n)
+	{
+		std::cerr << "[ERROR] [MULTI SPLINE] sample(): "
+		          << "Expected " << dimensions() << "x" << n << " outputs for " << n << " times, "
+		          << "but they were " << pos.rows() << "x" << pos.cols() << ", "
+		          << vel.rows() << "x" << vel.cols() << " and " << acc.rows() << "x" << acc.cols() << ".\n";
+
+		return false;
+	}
+
+	const Coefficients &s = *this->data;
+
+	const unsigned int last = s.times.size() - 2;                                               // Index of the final segment
+
+	Eigen::MatrixXd coefficients(dimensions(), 5);                                              // [c0 c1 c2 c3 c4] for one segment
+	Eigen::Matrix<double,5,Eigen::Dynamic> powers;                                              // 1, dt, ... dt^4 for each time
+
+	unsigned int i = 0;
+	unsigned int k = 0;                                                                         // Our own cursor
+
+	while(i < n)
+	{
+		if(times[i] >= s.times.back())                                                      // Finished, so stay at the end
+		{
+			pos.col(i) = s.endPoint;
+			vel.col(i).setZero();
+			acc.col(i).setZero();
+
+			i++;
+
+			continue;
+		}
+
+		if(times[i] < s.times[k])                                                           // Went backwards
+		{
+			int j = std::upper_bound(s.times.begin(), s.times.end(), times[i]) - s.times.begin() - 1;
+
+			k = std::max(0, j);                                                         // Before the start is the first segment
+		}
+		else while(k < last and times[i] >= s.times[k+1]) k++;                              // Walk forward
+
+		// All the times that follow in the same segment are done together
+		const double segmentEnd = k < last ? s.times[k+1] : s.times.back();
+
+		unsigned int m = 1;
+
+		while(i + m < n and times[i+m] >= s.times[k] and times[i+m] < segmentEnd) m++;
+
+		powers.resize(5, m);
+
+		for(unsigned int j = 0; j < m; j++)
+		{
+			double dt = std::max(times[i+j] - s.times[k], 0.0);                         // Hold the start before the first knot
+
+			powers.col(j) << 1, dt, dt*dt, dt*dt*dt, dt*dt*dt*dt;
+		}
+
+		coefficients << s.c0.col(k), s.c1.col(k), s.c2.col(k), s.c3.col(k), s.c4.col(k);
+
+		// Derivatives of the powers are the lower powers scaled by 1, 2, 3, 4 and 2, 6, 12
+		const Eigen::Vector4d rate(1, 2, 3, 4);
+		const Eigen::Vector3d curvature(2, 6, 12);
+
+		pos.middleCols(i,m).noalias() = coefficients*powers;
+		vel.middleCols(i,m).noalias() = coefficients.rightCols(4)*rate.asDiagonal()*powers.topRows(4);
+		acc.middleCols(i,m).noalias() = coefficients.rightCols(3)*curvature.asDiagonal()*powers.topRows(3);
+
+		if(this->pointShift.size() > 0)                                                     // Started somewhere else
+		{
+			const Eigen::Matrix<double,5,1> a = s.pointBasis.col(k);
+			const Eigen::Matrix<double,5,1> b = s.velocityBasis.col(k);
+			const Eigen::Matrix<double,5,1> c = s.accelerationBasis.col(k);
+
+			pos.middleCols(i,m).noalias() += this->pointShift*(a.transpose()*powers)
+			                               + this->velocityShift*(b.transpose()*powers)
+			                               + this->accelerationShift*(c.transpose()*powers);
+
+			vel.middleCols(i,m).noalias() += this->pointShift*(a.tail(4).cwiseProduct(rate).transpose()*powers.topRows(4))
+			                               + this->velocityShift*(b.tail(4).cwiseProduct(rate).transpose()*powers.topRows(4))
+			                               + this->accelerationShift*(c.tail(4).cwiseProduct(rate).transpose()*powers.topRows(4));
+
+			acc.middleCols(i,m).noalias() += this->pointShift*(a.tail(3).cwiseProduct(curvature).transpose()*powers.topRows(3))
+			                               + this->velocityShift*(b.tail(3).cwiseProduct(curvature).transpose()*powers.topRows(3))
+			                               + this->accelerationShift*(c.tail(3).cwiseProduct(curvature).transpose()*powers.topRows(3));
+		}
+
+		i += m;
+	}
+
+	return true;
+}
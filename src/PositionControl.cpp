@@ -1,5 +1,95 @@
 #include <PositionControl.h>
 
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                         Constructor                                            //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+PositionControl::PositionControl(const std::string              &pathToURDF,
+                                 const std::vector<std::string> &jointList,
+                                 const std::vector<std::string> &portList,
+                                 const std::string              &robotModel,
+                                 const JointInterface::Backend  &backend,
+                                 const SimulationParameters     &simulation)
+                                 :
+                                 iCubBase(pathToURDF, jointList, portList, robotModel, backend, simulation),
+                                 qRef(this->q),                                                     // Start from the current joint position
+                                 dq(Eigen::VectorXd::Zero(this->numJoints)),
+                                 jointReference(Eigen::VectorXd::Zero(this->numJoints)),
+                                 lowerBound(Eigen::VectorXd::Zero(this->numJoints)),
+                                 upperBound(Eigen::VectorXd::Zero(this->numJoints)),
+                                 redundantTask(Eigen::VectorXd::Zero(this->numJoints)),
+                                 startPoint(Eigen::VectorXd::Zero(this->numJoints)),
+                                 Jc(Eigen::MatrixXd::Zero(6,this->numJoints)),
+                                 JinvM(Eigen::MatrixXd::Zero(12,this->numJoints))
+{
+	if(this->_robotModel == "iCub2")
+	{
+		// Set the constraints for the iCub2 shoulder tendons.
+		// A *single* arm is constrained by
+		//      A*q + b > 0,
+		// but we have two arms so we need to double up the constraint matrix.
+		
+		double c = 1.71;
+		this->A = Eigen::MatrixXd::Zero(10,this->numJoints);
+		this->A.block(0,3,5,3) <<  c, -c,  0,
+		                           c, -c, -c,
+		                           0,  1,  1,
+		                          -c,  c,  c,
+		                           0, -1, -1;
+		                           
+		this->A.block(5,10,5,3) = this->A.block(0,3,5,3);                                   // Same constraint for right arm as left arm
+		
+		this->b.head(5) << 347.00*(M_PI/180),
+		                   366.57*(M_PI/180),
+		                    66.60*(M_PI/180),
+		                   112.42*(M_PI/180),
+		                   213.30*(M_PI/180);
+		                   
+		this->b.tail(5) = this->b.head(5);                                                  // Same constraint for the right arm
+		
+		// In discrete time we have:
+		// A*(q + dq) >= b ---> A*dq > -(A*q + b)
+		
+		// Bsmall = [ -I ]
+		//          [  I ]
+		//          [  A ]
+		this->Bsmall.resize(10+2*this->numJoints,this->numJoints);
+		this->Bsmall.block(              0,0,this->numJoints,this->numJoints) = -Eigen::MatrixXd::Identity(this->numJoints,this->numJoints);
+		this->Bsmall.block(this->numJoints,0,this->numJoints,this->numJoints) =  Eigen::MatrixXd::Identity(this->numJoints,this->numJoints);
+		this->Bsmall.block(2*this->numJoints,0,10,this->numJoints) = this->A;
+		
+		// NOTE: First 12 columns pertain to the Lagrange multipliers in Cartesian mode
+		// B = [ 0  -I ]
+		//     [ 0   I ]
+		//     [ 0   A ]
+		this->B.resize(10+2*this->numJoints,12+this->numJoints);
+		this->B.block(0, 0,10+2*this->numJoints,             12).setZero();
+		this->B.block(0,12,10+2*this->numJoints,this->numJoints) = this->Bsmall;
+		
+		// Size the QP problems for joint control, Cartesian control, and grasping
+		this->z = Eigen::VectorXd::Zero(10+2*this->numJoints);
+		
+		this->jointH = Eigen::MatrixXd::Identity(this->numJoints,this->numJoints);
+		this->jointF = Eigen::VectorXd::Zero(this->numJoints);
+		
+		this->cartesianH     = Eigen::MatrixXd::Zero(12+this->numJoints,12+this->numJoints);
+		this->cartesianF     = Eigen::VectorXd::Zero(12+this->numJoints);
+		this->cartesianStart = Eigen::VectorXd::Zero(12+this->numJoints);
+		
+		this->graspH     = Eigen::MatrixXd::Zero(6+this->numJoints,6+this->numJoints);
+		this->graspF     = Eigen::VectorXd::Zero(6+this->numJoints);
+		this->graspStart = Eigen::VectorXd::Zero(6+this->numJoints);
+		
+		QPSolver::reserve(   this->numJoints, 10+2*this->numJoints);
+		QPSolver::reserve(12+this->numJoints, 10+2*this->numJoints);
+		QPSolver::reserve( 6+this->numJoints, 10+2*this->numJoints);
+	}
+	else
+	{
+		QPSolver::reserve(this->numJoints, 2*this->numJoints, 12);                          // Both hands
+		QPSolver::reserve(this->numJoints, 2*this->numJoints,  6);                          // Grasp constraint
+	}
+}
+
   ////////////////////////////////////////////////////////////////////////////////////////////////////
  //                                 Initialise the control thread                                  //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -13,11 +103,14 @@ bool PositionControl::threadInit()
 	}
 	else
 	{
+		configure_current_thread(this->realTimeOptions);                                    // yarp makes a new thread on every start()
+		
 		// Reset values
 		QPSolver::clear_last_solution();                                                    // Remove last solution
-		this->isFinished = false;                                                           // New action started
+		this->overrunWarned = false;                                                        // Check the timing again
+		this->loopTimer.restart();                                                          // Don't count the pause as jitter
 		this->qRef = this->q;                                                               // Start from current joint position
-		this->startTime = yarp::os::Time::now();                                            // Used to time the control loop
+		this->ticks = 0;                                                                    // Warm up again
 		return true;                                                                        // jumps immediately to run()
 	}
 }
@@ -27,33 +120,46 @@ bool PositionControl::threadInit()
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 void PositionControl::run()
 {
+	if(this->ticks++ >= warmUpTicks) begin_allocation_check();                                  // Only in CHECK_ALLOCATIONS builds
+	
+	this->loopTimer.start_tick();
+	
+	adopt_new_plan();                                                                           // Switch to a new action if there is one
+	
+	adopt_new_gains();                                                                          // And to new gains, if they were reloaded
+	
 	if(update_state())
 	{
-		double elapsedTime = yarp::os::Time::now() - this->startTime;                       // Time since start of control
+		this->loopTimer.end_stage(LoopTimer::state);
+		
+		double elapsedTime = this->stateTime - plan().startTime;                            // When this command will take effect
+		
+		if(elapsedTime > plan().endTime) this->finishedPlan = plan().id;                    
 		
-		if(elapsedTime > this->endTime) this->isFinished = true;                            
+		Eigen::VectorXd &dq = this->dq;                                                     // We want to solve for this
+		dq.setZero();
 		
-		Eigen::VectorXd dq(this->numJoints); dq.setZero();                                  // We want to solve for this		
+		Eigen::VectorXd &lowerBound = this->lowerBound;                                     // Lower limit on joint motion
+		Eigen::VectorXd &upperBound = this->upperBound;                                     // Upper limit on joint motion
+		Eigen::VectorXd &startPoint = this->startPoint;                                     // of the interior point method
 		
-		if(this->controlSpace == joint)
+		if(plan().controlSpace == joint)
 		{
-			Eigen::VectorXd desiredPosition(this->numJoints);                           // From the trajectory object
-			Eigen::VectorXd lowerBound(this->numJoints);                                // Lower limit on joint motion
-			Eigen::VectorXd upperBound(this->numJoints);                                // Upper limit on joint motion
+			Eigen::VectorXd &desiredPosition = this->jointReference;                    // From the trajectory object
 				
+			plan().jointTrajectory.evaluate(elapsedTime, desiredPosition);              // All joints in one pass
+			
 			for(int i = 0; i < this->numJoints; i++)
 			{
-				desiredPosition(i) = this->jointTrajectory[i].evaluatePoint(elapsedTime); // From the trajectory object
-				
 				compute_joint_limits(lowerBound(i),upperBound(i),i);                // Instantaneous limits on the joint step				
 			}
 			
+			this->loopTimer.end_stage(LoopTimer::reference);
+			
 			if(this->_robotModel == "iCub2")
 			{
 				// We need to run the QP solver to account for shoulder joint constraints
 				
-				Eigen::VectorXd startPoint;                                         // of the interior point method
-				
 				if(QPSolver::last_solution_exists())
 				{
 					startPoint = QPSolver::last_solution().tail(this->numJoints); // Remove any lagrange multipliers that could exist
@@ -77,15 +183,16 @@ void PositionControl::run()
 				//     [    dq_min  ]
 				//     [ -(A*q + b) ]
 				
-				Eigen::VectorXd z(2*this->numJoints + 10);
-				z.block(              0, 0, this->numJoints, 1) = -upperBound;      // Upper limits on the joint motion
-				z.block(this->numJoints, 0, this->numJoints, 1) =  lowerBound;      // Lower limits on the joint motion
-				z.tail(10) = -(this->A*this->q + b);                                // Shoulder constraints on the joint motion
+				this->z.block(              0, 0, this->numJoints, 1) = -upperBound; // Upper limits on the joint motion
+				this->z.block(this->numJoints, 0, this->numJoints, 1) =  lowerBound; // Lower limits on the joint motion
+				this->z.tail(10).noalias() = -this->A*this->q;                      // Shoulder constraints on the joint motion
+				this->z.tail(10) -= this->b;
+				
+				this->jointF = this->qRef - desiredPosition;
 				
 				try // to solve the QP problem
 				{
-					dq = QPSolver::solve(Eigen::MatrixXd::Identity(this->numJoints,this->numJoints),
-					                     -(desiredPosition - this->qRef), this->Bsmall, z, startPoint);
+					dq = QPSolver::solve(this->jointH, this->jointF, this->Bsmall, this->z, startPoint);
 				}
 				catch(const std::exception &exception)
 				{
@@ -107,29 +214,28 @@ void PositionControl::run()
 		}
 		else // this->controlSpace == Cartesian
 		{
-			Eigen::VectorXd dx = track_cartesian_trajectory(elapsedTime);               // Get the required Cartesian motion
+			Eigen::Matrix<double,12,1> dx = track_cartesian_trajectory(elapsedTime);    // Get the required Cartesian motion
 			
-			Eigen::VectorXd redundantTask = 0.01*(this->desiredPosition - this->q);     // q OR qRef ???
+			this->redundantTask = (this->dt*redundantGain)*(this->desiredPosition - this->q); // q OR qRef ???
 			
 			// Get the instantaneous limits on the joint motion
-			Eigen::VectorXd lowerBound(this->numJoints), upperBound(this->numJoints);
 			for(int i = 0; i < this->numJoints; i++)
 			{
 				compute_joint_limits(lowerBound(i),upperBound(i),i);
 			}
 			
+			this->loopTimer.end_stage(LoopTimer::reference);
+			
 			if(this->_robotModel == "iCub2")
 			{
 				// NOTE: We need to solve a custom QP problem to account
 				// for the iCub2's shoulder constraints ಠ_ಠ
 				// I put it in a separate function because it's long and ugly
 				
-				dq = icub2_cartesian_control(dx, redundantTask, lowerBound, upperBound);
+				icub2_cartesian_control(dx, this->redundantTask, lowerBound, upperBound, dq);
 			}
 			else // this->_robotModel = "ergoCub"
 			{
-				Eigen::VectorXd startPoint(this->numJoints);                        // Required by the QP solver
-				
 				if(QPSolver::last_solution_exists())
 				{
 					startPoint = QPSolver::last_solution().tail(this->numJoints); // Remove any Lagrange multipliers
@@ -142,14 +248,16 @@ void PositionControl::run()
 				}
 				else startPoint = 0.5*(lowerBound + upperBound);
 				
-				double mu = sqrt((this->J*this->J.transpose()).determinant());      // Proximity to singularity				
+				Eigen::Matrix<double,12,12> JJt; JJt.noalias() = this->J*this->J.transpose();
+				
+				double mu = sqrt(JJt.determinant());                                // Proximity to singularity
 				
 				if(mu > this->threshold) // i.e. not singular
 				{
 					try // to solve the QP problem
 					{
 					        // SO EASY compared to iCub2 ಥ‿ಥ
-						dq = QPSolver::redundant_least_squares(redundantTask, this->M, dx, this->J,
+						dq = QPSolver::redundant_least_squares(this->redundantTask, this->M, dx, this->J,
 					                                               lowerBound, upperBound, startPoint); 
 					}
 					catch(const std::exception &exception)
@@ -202,9 +310,9 @@ void PositionControl::run()
 					
 					try // Too easy lol ᕙ(▀̿̿ĺ̯̿̿▀̿ ̿) ᕗ
 					{
-						Eigen::MatrixXd Jc = this->C*this->J;
+						this->Jc.noalias() = this->C*this->J;
 				
-						dq = QPSolver::redundant_least_squares(dq, this->M, dc, Jc, lowerBound, upperBound, dq);
+						dq = QPSolver::redundant_least_squares(dq, this->M, dc, this->Jc, lowerBound, upperBound, dq);
 					}
 					catch(const std::exception &exception)
 					{
@@ -214,10 +322,20 @@ void PositionControl::run()
 			}
 		}
 	
+		this->loopTimer.end_stage(LoopTimer::solve);
+		
 		this->qRef += dq;                                                                   // Update reference position for joint motors
 		
 		if(not send_joint_commands(qRef)) std::cout << "[ERROR] [POSITION CONTROL] Could not send joint commands for some reason.\n";
+		
+		this->loopTimer.end_stage(LoopTimer::command);
 	}
+	
+	this->loopTimer.end_tick(this->dt);
+	
+	check_timing();                                                                             // Make sure we can keep up
+	
+	end_allocation_check("PositionControl::run()");                                             // Aborts if anything was allocated
 }
 
   ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -271,39 +389,44 @@ Eigen::Matrix<double,12,1> PositionControl::track_cartesian_trajectory(const dou
 	
 	// Variables used in this scope
 	Eigen::Matrix<double,12,1> dx; dx.setZero();                                                // Value to be returned
-	Eigen::Isometry3d pose;                                                                     // Desired pose
-	Eigen::Matrix<double,6,1> vel, acc;                                                         // Desired velocity & acceleration
+	Eigen::Isometry3d pose[2];                                                                  // Desired poses
+	Eigen::Matrix<double,6,1> vel[2], acc;                                                      // Desired velocities & acceleration
+	
+	bool streamed = plan().controlSpace == streaming
+	            and this->setpoints.interpolate(this->stateTime - this->streamDelay, this->isGrasping ? 1 : 2, pose, vel);
+	
+	if(not streamed)                                                                            // Follow the trajectory (or hold still until the stream starts)
+	{
+		if(this->isGrasping) plan().payloadTrajectory.get_state(pose[0],vel[0],acc,time);   // Get the desired object state for the given time
+		else
+		{
+			plan().leftTrajectory.get_state(pose[0],vel[0],acc,time);                    // Desired state for the left hand
+			plan().rightTrajectory.get_state(pose[1],vel[1],acc,time);                   // Desired state for the right hand
+		}
+	}
 	
 	if(this->isGrasping)
 	{
-		this->payloadTrajectory.get_state(pose,vel,acc,time);                               // Get the desired object state for the given time              
-		
-		dx = this->G.transpose()*(this->dt*vel + this->K*pose_error(pose,this->payload.pose())); // Feedforward + feedback control		
+		dx = this->dt*this->G.transpose()*(vel[0] + this->K*pose_error(pose[0],this->payload.pose())); // Feedforward + feedback control		
 	}
 	else
 	{
-		this->leftTrajectory.get_state(pose,vel,acc,time);                                  // Desired state for the left hand
-		dx.head(6) = this->dt*vel + this->K*pose_error(pose,this->leftPose);                // Feedforward + feedback on the left hand
-
-		this->rightTrajectory.get_state(pose,vel,acc,time);                                 // Desired state for the right hand
-		dx.tail(6) = this->dt*vel + this->K*pose_error(pose,this->rightPose);               // Feedforward + feedback on the right hand
+		dx.head(6) = this->dt*(vel[0] + this->K*pose_error(pose[0],this->leftPose));        // Feedforward + feedback on the left hand
+		dx.tail(6) = this->dt*(vel[1] + this->K*pose_error(pose[1],this->rightPose));       // Feedforward + feedback on the right hand
 	}
 	
 	return dx;
 }
 
   ////////////////////////////////////////////////////////////////////////////////////////////////////
- //                     Solve the step size to track the joint trajectory                          //
+ //                Turn the pre-flight check on or off, with the constraints for this robot        //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-Eigen::VectorXd PositionControl::track_joint_trajectory(const double &time)
+bool PositionControl::enable_preflight(const bool &active)
 {
-	Eigen::VectorXd dq(this->numJoints); dq.setZero();                                          // Value to be returned
-	
-	for(int i = 0; i < this->numJoints; i++) dq[i] = this->jointTrajectory[i].evaluatePoint(time) - this->q[i];
-	
-	return dq;
+	if(this->_robotModel == "iCub2") return create_preflight(active, this->A, this->b);         // Shoulder constraints
+	else                             return iCubBase::enable_preflight(active);
 }
- 
+  
   ////////////////////////////////////////////////////////////////////////////////////////////////////
  //                       Compute a fake grasp force to apply between hands                        //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -313,7 +436,7 @@ Eigen::Matrix<double,6,1> PositionControl::grasp_correction()
 	
 	double actualWidth = (this->leftPose.translation() - this->rightPose.translation()).norm();
 	
-	double scalar = this->kp*(this->graspWidth - actualWidth)/2;
+	double scalar = this->dt*this->kp*(this->graspWidth - actualWidth)/2;                       // kp is per second
 	
 	Eigen::Matrix<double,6,1> temp;
 	temp.head(3) = scalar*(R.col(0) + R.col(1) + R.col(2));
@@ -325,37 +448,41 @@ Eigen::Matrix<double,6,1> PositionControl::grasp_correction()
   ///////////////////////////////////////////////////////////////////////////////////////////////////
  //                       Standard Cartesian method for iCub2                                     //
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-Eigen::VectorXd PositionControl::icub2_cartesian_control(const Eigen::Matrix<double,12,1> &dx,
-                                                         const Eigen::VectorXd &redundantTask,
-                                                         const Eigen::VectorXd &lowerBound,
-                                                         const Eigen::VectorXd &upperBound)
+void PositionControl::icub2_cartesian_control(const Eigen::Matrix<double,12,1> &dx,
+                                              const Eigen::VectorXd &redundantTask,
+                                              const Eigen::VectorXd &lowerBound,
+                                              const Eigen::VectorXd &upperBound,
+                                              Eigen::VectorXd &dq)
 {
 	// We need to formulate the full start point of Lagrange multipliers
 	// AND the joint control since iCub2 requires us to call the
 	// interior point method directly rather than use a shortcut function
 	// (ノಠ益ಠ)ノ彡┻━┻
 	
-	Eigen::VectorXd dq(this->numJoints); dq.setZero();                                          // We want to solve for this
+	dq.setZero();                                                                               // We want to solve for this
 	
 	// Constraint vector does not change						
 	// z = [   -dq_max  ]
 	//     [    dq_min  ]
 	//     [ -(A*q + b) ]
 	
-	Eigen::VectorXd z(2*this->numJoints+10);
+	Eigen::VectorXd &z = this->z;
 	z.block(              0, 0, this->numJoints, 1) = -upperBound;
 	z.block(this->numJoints, 0, this->numJoints, 1) =  lowerBound;
-	z.tail(10) = -(this->A*this->q + this->b);
+	z.tail(10).noalias() = -this->A*this->q;
+	z.tail(10) -= this->b;
 	
-	double mu = sqrt((this->J*this->J.transpose()).determinant());                              // Proximity to a singularity
+	Eigen::Matrix<double,12,12> JJt; JJt.noalias() = this->J*this->J.transpose();
+	
+	double mu = sqrt(JJt.determinant());                                                        // Proximity to a singularity
 	
 	if(mu > this->threshold)                                                                    // i.e. not singular
 	{	
-		Eigen::VectorXd startPoint(12+this->numJoints);                                     // +12 for Lagrange multipliers
+		Eigen::VectorXd &startPoint = this->cartesianStart;                                 // +12 for Lagrange multipliers
 	
 		if(QPSolver::last_solution_exists())
 		{
-			Eigen::VectorXd lastSolution = QPSolver::last_solution();   
+			const Eigen::VectorXd &lastSolution = QPSolver::last_solution();   
 				
 			if(lastSolution.size() == (12+this->numJoints)) startPoint = lastSolution;  // Lagrange multipliers & joint control
 			else
@@ -379,8 +506,7 @@ Eigen::VectorXd PositionControl::icub2_cartesian_control(const Eigen::Matrix<dou
 
 		// H = [ 0  J ]
 		//     [ J' M ]
-		Eigen::MatrixXd H(12+this->numJoints, 12+this->numJoints);
-		H.resize(12+this->numJoints,12+this->numJoints);
+		Eigen::MatrixXd &H = this->cartesianH;
 		H.block( 0, 0,              12,              12).setZero();
 		H.block( 0,12,              12, this->numJoints) = this->J;
 		H.block(12, 0, this->numJoints,              12) = this->J.transpose();
@@ -388,10 +514,9 @@ Eigen::VectorXd PositionControl::icub2_cartesian_control(const Eigen::Matrix<dou
 		
 		// f = [        -dx        ]
 		//     [  -M*redundantTask ]
-		Eigen::VectorXd f(12+this->numJoints);
-		f.resize(12+this->numJoints);
-		f.head(12)              = -dx;
-		f.tail(this->numJoints) = -M*redundantTask;
+		Eigen::VectorXd &f = this->cartesianF;
+		f.head(12)                        = -dx;
+		f.tail(this->numJoints).noalias() = -this->M*redundantTask;
 
 		// B = [ 0 -I ]
 		//     [ 0  I ]
@@ -456,7 +581,8 @@ Eigen::VectorXd PositionControl::icub2_cartesian_control(const Eigen::Matrix<dou
 	{
 		// Solve again subject to grasp constraints
 		
-		Eigen::MatrixXd Jc = this->C*this->J;                                               // Constraint matrix
+		Eigen::MatrixXd &Jc = this->Jc;
+		Jc.noalias() = this->C*this->J;                                                     // Constraint matrix
 		
 		Eigen::Matrix<double,6,1> dc = grasp_correction();
 		
@@ -464,7 +590,7 @@ Eigen::VectorXd PositionControl::icub2_cartesian_control(const Eigen::Matrix<dou
 		
 		// H = [ 0   Jc ]
 		//     [ Jc' I  ]
-		Eigen::MatrixXd H(6+this->numJoints,6+this->numJoints);
+		Eigen::MatrixXd &H = this->graspH;
 		H.block( 0, 0,               6,               6).setZero();
 		H.block( 0, 6,               6, this->numJoints) = Jc;
 		H.block( 6, 0, this->numJoints,               6) = Jc.transpose();
@@ -472,7 +598,7 @@ Eigen::VectorXd PositionControl::icub2_cartesian_control(const Eigen::Matrix<dou
 		
 		// f = [  0  ]
 		//     [ -dq ]
-		Eigen::VectorXd f(6+this->numJoints);
+		Eigen::VectorXd &f = this->graspF;
 		f.head(6) = -dc;
 		f.tail(this->numJoints) = -dq;
 		
@@ -485,8 +611,11 @@ Eigen::VectorXd PositionControl::icub2_cartesian_control(const Eigen::Matrix<dou
 		
 		// B.block(6,0,10+2*this->numJoints,6+this->numJoints);
 		
-		Eigen::VectorXd startPoint(6+this->numJoints);
-		startPoint.head(6)               = (Jc*Jc.transpose()).partialPivLu().solve(Jc*dq - dc); // Lagrange multipliers for the grasp constraint
+		Eigen::Matrix<double,6,6> JcJct; JcJct.noalias() = Jc*Jc.transpose();
+		Eigen::Matrix<double,6,1> error; error.noalias() = Jc*dq; error -= dc;
+		
+		Eigen::VectorXd &startPoint = this->graspStart;
+		startPoint.head(6)               = JcJct.partialPivLu().solve(error);               // Lagrange multipliers for the grasp constraint
 		startPoint.tail(this->numJoints) = dq;                                              // Use current solution
 		
 		try
@@ -502,7 +631,6 @@ Eigen::VectorXd PositionControl::icub2_cartesian_control(const Eigen::Matrix<dou
 		}
 	}
 	
-	return dq;
 }
 
   ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -519,5 +647,14 @@ Eigen::Matrix<double,12,1> PositionControl::lagrange_multipliers(const Eigen::Ma
 		
 		return Eigen::VectorXd::Zero(12);
 	}
-	else	return (this->J*this->invM*this->J.transpose()).partialPivLu().solve(this->J*redundantTask - dx);
+	else
+	{
+		this->JinvM.noalias() = this->J*this->invM;
+		
+		Eigen::Matrix<double,12,12> JinvMJt; JinvMJt.noalias() = this->JinvM*this->J.transpose();
+		
+		Eigen::Matrix<double,12,1> error; error.noalias() = this->J*redundantTask; error -= dx;
+		
+		return JinvMJt.partialPivLu().solve(error);
+	}
 }
@@ -0,0 +1,441 @@
+#include <PreFlight.h>
+
+#include <iCubBase.h>                                                                               // iCubBase::pose_error()
+#include <sstream>                                                                                  // std::stringstream
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                         Constructor                                            //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+PreFlight::PreFlight(const iDynTree::Model                   &model,
+                     const iDynTree::Transform               &_basePose,
+                     const std::vector<std::array<double,2>> &_positionLimit,
+                     const std::vector<double>               &_velocityLimit)
+                     :
+                     numJoints(_positionLimit.size()),
+                     positionLimit(_positionLimit),
+                     velocityLimit(_velocityLimit),
+                     basePose(_basePose),
+                     gravity(std::vector<double> {0.0, 0.0, -9.81}),
+                     jacobianBuffer(Eigen::MatrixXd::Zero(6,6+_positionLimit.size())),
+                     massBuffer(Eigen::MatrixXd::Zero(6+_positionLimit.size(),6+_positionLimit.size())),
+                     jointPositionBuffer(_positionLimit.size()),
+                     jointVelocityBuffer(_positionLimit.size())
+{
+	std::string message = "[ERROR] [PRE-FLIGHT] Constructor: ";
+
+	if(this->velocityLimit.size() != this->numJoints)
+	{
+		throw std::invalid_argument(message + "There were " + std::to_string(this->numJoints) + " position limits "
+		                            "but " + std::to_string(this->velocityLimit.size()) + " velocity limits.");
+	}
+
+	if(not this->computer.loadRobotModel(model))
+	{
+		throw std::runtime_error(message + "Could not load the model in to iDynTree::KinDynComputations.");
+	}
+
+	this->jointVelocityBuffer.zero();                                                           // Rolled out at rest
+
+	QPSolver::reserve(this->numJoints, 2*this->numJoints, 12);                                  // Same problem as the control loop
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                      Add linear constraints on the joints, like the iCub2 shoulders            //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void PreFlight::set_constraints(const Eigen::MatrixXd &_A, const Eigen::VectorXd &_b)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	this->A = _A;
+	this->b = _b;
+
+	// B = [ 0 -I ]
+	//     [ 0  I ]
+	//     [ 0  A ]
+	// with the first 12 columns for the Lagrange multipliers, as in PositionControl
+	this->constraintMatrix = Eigen::MatrixXd::Zero(2*this->numJoints + this->A.rows(), 12 + this->numJoints);
+	this->constraintMatrix.block(              0,12,this->numJoints,this->numJoints) = -Eigen::MatrixXd::Identity(this->numJoints,this->numJoints);
+	this->constraintMatrix.block(this->numJoints,12,this->numJoints,this->numJoints) =  Eigen::MatrixXd::Identity(this->numJoints,this->numJoints);
+	this->constraintMatrix.block(2*this->numJoints,12,this->A.rows(),this->numJoints) = this->A;
+
+	QPSolver::reserve(12 + this->numJoints, this->constraintMatrix.rows());                     // Same problem as the iCub2 control loop
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                       Check a joint trajectory against the limits of the motors                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool PreFlight::check_joint_motion(const MultiSpline &trajectory,
+                                   const double      &dt,
+                                   std::string       &diagnosis)
+{
+	if(trajectory.dimensions() != this->numJoints or dt <= 0)
+	{
+		diagnosis = "The trajectory had " + std::to_string(trajectory.dimensions()) + " joints "
+		            "but the robot has " + std::to_string(this->numJoints) + ".";
+
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	std::vector<double> times;
+	for(double t = trajectory.start_time(); t < trajectory.end_time() + dt; t += dt) times.push_back(t);
+
+	Eigen::MatrixXd pos(this->numJoints, times.size()), vel(this->numJoints, times.size()), acc(this->numJoints, times.size());
+
+	trajectory.sample(times, pos, vel, acc);                                                    // The whole thing in one go
+
+	double slowdown = 1.0;                                                                      // To bring the speeds within the limits
+	unsigned int fastestJoint = 0;
+	double fastestTime = 0.0;
+
+	for(int k = 0; k < times.size(); k++)
+	{
+		for(int i = 0; i < this->numJoints; i++)
+		{
+			if(pos(i,k) < this->positionLimit[i][0] or pos(i,k) > this->positionLimit[i][1])
+			{
+				std::stringstream stream;
+				stream << "Joint '" << joint_name(i) << "' would reach " << pos(i,k) << " rad at t = "
+				       << times[k] - times[0] << " s, outside its limits of [" << this->positionLimit[i][0]
+				       << ", " << this->positionLimit[i][1] << "].";
+
+				diagnosis = stream.str();
+
+				return false;
+			}
+
+			double ratio = std::abs(vel(i,k))/this->velocityLimit[i];
+
+			if(ratio > slowdown)
+			{
+				slowdown     = ratio;
+				fastestJoint = i;
+				fastestTime  = times[k] - times[0];
+			}
+		}
+
+		if(not check_constraints(pos.col(k), times[k] - times[0], diagnosis)) return false;
+	}
+
+	if(slowdown > 1.0)
+	{
+		std::stringstream stream;
+		stream << "Joint '" << joint_name(fastestJoint) << "' would need "
+		       << slowdown*this->velocityLimit[fastestJoint] << " rad/s at t = " << fastestTime
+		       << " s, but its limit is " << this->velocityLimit[fastestJoint] << " rad/s. "
+		       << "The action would have to take " << slowdown << " times as long.";
+
+		diagnosis = stream.str();
+
+		return false;
+	}
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //             Roll out the hand trajectories through the same steps as the control loop          //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool PreFlight::check_cartesian_motion(const Eigen::VectorXd           &startPosition,
+                                       const CartesianTrajectory       &left,
+                                       const CartesianTrajectory       &right,
+                                       const double                    &duration,
+                                       const Eigen::VectorXd           &desiredPosition,
+                                       const Eigen::Matrix<double,6,6> &K,
+                                       const double                    &threshold,
+                                       const double                    &dt,
+                                       std::string                     &diagnosis)
+{
+	if(startPosition.size() != this->numJoints or desiredPosition.size() != this->numJoints or dt <= 0)
+	{
+		diagnosis = "The start position had " + std::to_string(startPosition.size()) + " joints "
+		            "but the robot has " + std::to_string(this->numJoints) + ".";
+
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	// Sample both hand trajectories for every step in advance
+	std::vector<double> times;
+	for(double t = dt; t < duration + dt; t += dt) times.push_back(t);
+
+	unsigned int n = times.size();
+
+	std::vector<Eigen::Isometry3d> leftPoses(n), rightPoses(n);
+	Eigen::MatrixXd leftTwists(6,n), rightTwists(6,n), acc(6,n);
+
+	if(not left.sample(times, leftPoses, leftTwists, acc)
+	or not right.sample(times, rightPoses, rightTwists, acc))
+	{
+		diagnosis = "Could not sample the hand trajectories.";
+
+		return false;
+	}
+
+	Eigen::VectorXd q = startPosition;
+	Eigen::VectorXd lowerBound(this->numJoints), upperBound(this->numJoints), startPoint(this->numJoints);
+	Eigen::VectorXd dq(this->numJoints), redundantTask(this->numJoints);
+	Eigen::MatrixXd J(12, this->numJoints), M(this->numJoints, this->numJoints);
+	Eigen::Matrix<double,12,1> dx;
+	Eigen::Isometry3d leftPose, rightPose;
+
+	QPSolver::clear_last_solution();
+
+	for(unsigned int k = 0; k <= n; k++)                                                        // One extra to measure the final pose
+	{
+		for(int i = 0; i < this->numJoints; i++) this->jointPositionBuffer(i) = q(i);
+
+		if(not this->computer.setRobotState(this->basePose,
+		                                    this->jointPositionBuffer,
+		                                    iDynTree::Twist(iDynTree::GeomVector3(0,0,0), iDynTree::GeomVector3(0,0,0)),
+		                                    this->jointVelocityBuffer,
+		                                    this->gravity))
+		{
+			diagnosis = "Could not set the state of the kinematic model.";
+
+			return false;
+		}
+
+		leftPose  = to_isometry(this->computer.getWorldTransform("left"));
+		rightPose = to_isometry(this->computer.getWorldTransform("right"));
+
+		if(k == n) break;                                                                   // Finished the trajectory
+
+		this->computer.getFrameFreeFloatingJacobian("left", this->jacobianBuffer);
+		J.topRows(6) = this->jacobianBuffer.rightCols(this->numJoints);
+
+		this->computer.getFrameFreeFloatingJacobian("right", this->jacobianBuffer);
+		J.bottomRows(6) = this->jacobianBuffer.rightCols(this->numJoints);
+
+		this->computer.getFreeFloatingMassMatrix(this->massBuffer);
+		M = this->massBuffer.bottomRightCorner(this->numJoints, this->numJoints);
+
+		Eigen::Matrix<double,12,12> JJt = J*J.transpose();
+
+		double mu = sqrt(JJt.determinant());                                                // Proximity to singularity
+
+		if(mu <= threshold)
+		{
+			std::stringstream stream;
+			stream << "The arms would be (near) singular at t = " << times[k] << " s. Manipulability would be "
+			       << mu << " but the threshold is " << threshold << ".";
+
+			diagnosis = stream.str();
+
+			return false;
+		}
+
+		// Feedforward + feedback, as in the control loop
+		dx.head(6) = dt*(leftTwists.col(k)  + K*iCubBase::pose_error(leftPoses[k],  leftPose));
+		dx.tail(6) = dt*(rightTwists.col(k) + K*iCubBase::pose_error(rightPoses[k], rightPose));
+
+		for(int i = 0; i < this->numJoints; i++)
+		{
+			lowerBound(i) = this->positionLimit[i][0] - q(i);
+			upperBound(i) = this->positionLimit[i][1] - q(i);
+		}
+
+		redundantTask = (dt*iCubBase::redundantGain)*(desiredPosition - q);
+
+		try
+		{
+			if(this->A.rows() > 0) solve_constrained(dx, redundantTask, J, M, q, lowerBound, upperBound, dq);
+			else
+			{
+				if(QPSolver::last_solution_exists())
+				{
+					startPoint = QPSolver::last_solution().tail(this->numJoints);
+
+					for(int i = 0; i < this->numJoints; i++)
+					{
+						     if(startPoint(i) <= lowerBound(i)) startPoint(i) = lowerBound(i) + 0.01;
+						else if(startPoint(i) >= upperBound(i)) startPoint(i) = upperBound(i) - 0.01;
+					}
+				}
+				else startPoint = 0.5*(lowerBound + upperBound);
+
+				dq = QPSolver::redundant_least_squares(redundantTask, M, dx, J, lowerBound, upperBound, startPoint);
+			}
+		}
+		catch(const std::exception &exception)
+		{
+			diagnosis = "The solver failed at t = " + std::to_string(times[k]) + " s: " + exception.what();
+
+			return false;
+		}
+
+		for(int i = 0; i < this->numJoints; i++)
+		{
+			if(std::abs(dq(i)) > this->velocityLimit[i]*dt)
+			{
+				std::stringstream stream;
+				stream << "Joint '" << joint_name(i) << "' would need " << std::abs(dq(i))/dt
+				       << " rad/s at t = " << times[k] << " s, but its limit is "
+				       << this->velocityLimit[i] << " rad/s.";
+
+				diagnosis = stream.str();
+
+				return false;
+			}
+		}
+
+		q += dq;
+
+		if(not check_constraints(q, times[k], diagnosis)) return false;
+	}
+
+	// Make sure the hands actually got there
+	const Eigen::Isometry3d *target[2] = {&leftPoses.back(), &rightPoses.back()};
+	const Eigen::Isometry3d *actual[2] = {&leftPose, &rightPose};
+	const std::string hand[2]          = {"left", "right"};
+
+	for(int j = 0; j < 2 and n > 0; j++)
+	{
+		Eigen::Matrix<double,6,1> error = iCubBase::pose_error(*target[j], *actual[j]);
+
+		if(error.head(3).norm() > positionTolerance or error.tail(3).norm() > orientationTolerance)
+		{
+			std::stringstream stream;
+			stream << "The " << hand[j] << " hand would finish " << error.head(3).norm() << " m and "
+			       << error.tail(3).norm() << " rad from its target.";
+
+			std::string limits = joints_at_limits(q);
+
+			if(not limits.empty()) stream << " These joints would be at their limits: " << limits << ".";
+
+			diagnosis = stream.str();
+
+			return false;
+		}
+	}
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //      Solve the Cartesian step with the joint constraints, like icub2_cartesian_control()       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void PreFlight::solve_constrained(const Eigen::Matrix<double,12,1> &dx,
+                                  const Eigen::VectorXd            &redundantTask,
+                                  const Eigen::MatrixXd            &J,
+                                  const Eigen::MatrixXd            &M,
+                                  const Eigen::VectorXd            &q,
+                                  const Eigen::VectorXd            &lowerBound,
+                                  const Eigen::VectorXd            &upperBound,
+                                  Eigen::VectorXd                  &dq)
+{
+	unsigned int m = this->A.rows();
+
+	// z = [   -dq_max  ]
+	//     [    dq_min  ]
+	//     [ -(A*q + b) ]
+	Eigen::VectorXd z(2*this->numJoints + m);
+	z.head(this->numJoints)                     = -upperBound;
+	z.segment(this->numJoints, this->numJoints) =  lowerBound;
+	z.tail(m)                                   = -(this->A*q + this->b);
+
+	// H = [ 0  J ]
+	//     [ J' M ]
+	Eigen::MatrixXd H = Eigen::MatrixXd::Zero(12 + this->numJoints, 12 + this->numJoints);
+	H.block( 0,12,              12,this->numJoints) = J;
+	H.block(12, 0, this->numJoints,             12) = J.transpose();
+	H.block(12,12, this->numJoints,this->numJoints) = M;
+
+	// f = [        -dx        ]
+	//     [  -M*redundantTask ]
+	Eigen::VectorXd f(12 + this->numJoints);
+	f.head(12)              = -dx;
+	f.tail(this->numJoints) = -M*redundantTask;
+
+	Eigen::VectorXd startPoint(12 + this->numJoints);                                           // Lagrange multipliers & joint step
+
+	if(QPSolver::last_solution_exists() and QPSolver::last_solution().size() == startPoint.size())
+	{
+		startPoint = QPSolver::last_solution();
+	}
+	else
+	{
+		Eigen::MatrixXd JinvM = J*M.partialPivLu().inverse();
+
+		Eigen::Matrix<double,12,12> JinvMJt = JinvM*J.transpose();
+
+		startPoint.head(12) = JinvMJt.partialPivLu().solve(J*redundantTask - dx);           // Same guess as lagrange_multipliers()
+
+		startPoint.tail(this->numJoints) = 0.5*(lowerBound + upperBound);
+	}
+
+	for(int i = 0; i < this->numJoints; i++)
+	{
+		     if(startPoint(12+i) <= lowerBound(i)) startPoint(12+i) = lowerBound(i) + 0.01;
+		else if(startPoint(12+i) >= upperBound(i)) startPoint(12+i) = upperBound(i) - 0.01;
+	}
+
+	dq = QPSolver::solve(H, f, this->constraintMatrix, z, startPoint).tail(this->numJoints);
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                               Check A*q + b >= 0, if it was set                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool PreFlight::check_constraints(const Eigen::VectorXd &q, const double &time, std::string &diagnosis) const
+{
+	if(this->A.rows() == 0) return true;
+
+	Eigen::VectorXd margin = this->A*q + this->b;
+
+	for(int i = 0; i < margin.size(); i++)
+	{
+		if(margin(i) < 0)
+		{
+			std::stringstream stream;
+			stream << "Joint constraint " << i << " (shoulder) would be broken by "
+			       << -margin(i) << " at t = " << time << " s.";
+
+			diagnosis = stream.str();
+
+			return false;
+		}
+	}
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                  Name of a joint in the model                                  //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::string PreFlight::joint_name(const unsigned int &i) const
+{
+	return this->computer.model().getJointName(i);                                              // Same order as the joint list
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                        List the joints that are at (or very near) their limits                 //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::string PreFlight::joints_at_limits(const Eigen::VectorXd &q) const
+{
+	std::string list;
+
+	for(int i = 0; i < this->numJoints; i++)
+	{
+		if(q(i) - this->positionLimit[i][0] < limitMargin or this->positionLimit[i][1] - q(i) < limitMargin)
+		{
+			if(not list.empty()) list += ", ";
+
+			list += joint_name(i);
+		}
+	}
+
+	return list;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                           Convert iDynTree::Transform to Eigen::Isometry3d                     //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+Eigen::Isometry3d PreFlight::to_isometry(const iDynTree::Transform &T)
+{
+	iDynTree::Position pos = T.getPosition();
+	iDynTree::Vector4 quat = T.getRotation().asQuaternion();
+
+	return Eigen::Translation3d(pos[0],pos[1],pos[2])*Eigen::Quaterniond(quat[0],quat[1],quat[2],quat[3]);
+}
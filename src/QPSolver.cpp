@@ -30,11 +30,11 @@ Eigen::VectorXd QPSolver::solve(const Eigen::MatrixXd &H,
   ///////////////////////////////////////////////////////////////////////////////////////////////////
  //          Solve a constrained QP problem: min 0.5*x'*H*x + x'*f subject to: B*x >= z           //
 ///////////////////////////////////////////////////////////////////////////////////////////////////
-Eigen::VectorXd QPSolver::solve(const Eigen::MatrixXd &H,
-                                const Eigen::VectorXd &f,
-                                const Eigen::MatrixXd &B,
-                                const Eigen::VectorXd &z,
-                                const Eigen::VectorXd &x0)
+const Eigen::VectorXd& QPSolver::solve(const Eigen::Ref<const Eigen::MatrixXd> &H,
+                                       const Eigen::Ref<const Eigen::VectorXd> &f,
+                                       const Eigen::Ref<const Eigen::MatrixXd> &B,
+                                       const Eigen::Ref<const Eigen::VectorXd> &z,
+                                       const Eigen::Ref<const Eigen::VectorXd> &x0)
 {
 	int dim = x0.size();                                                                        // Dimensions for the state vector
 	int numConstraints = B.rows();                                                              // As it says
@@ -81,81 +81,70 @@ Eigen::VectorXd QPSolver::solve(const Eigen::MatrixXd &H,
 		//
 		//    I(x) = H + u*sum((1/(d_i^2))*b_i'*b_i)
 		
-		// Local variables
-	
-		Eigen::MatrixXd I;                                                                  // Hessian matrix
-		Eigen::VectorXd g(dim);                                                             // Gradient vector
-		Eigen::VectorXd dx = Eigen::VectorXd::Zero(dim);                                    // Newton step = -I^-1*g
-		Eigen::VectorXd x = x0;                                                             // Assign initial state variable
+		Workspace &space = workspace(dim, numConstraints);                                   // Nothing is allocated after the first time
+		
+		space.x = x0;                                                                       // Assign initial state variable
 		
 		double alpha;                                                                        // Scalar for Newton step
 		double beta  = this->beta0;                                                          // Shrinks barrier function
 		double u     = this->u0;                                                             // Scalar for barrier function
-	
-		std::vector<double> d; d.resize(numConstraints);
-		
-		// Do some pre-processing
-		std::vector<Eigen::VectorXd> bt(numConstraints);
-		std::vector<Eigen::MatrixXd> btb(numConstraints);
-		for(int j = 0; j < numConstraints; j++)
-		{
-			bt[j]  = B.row(j).transpose();                                              // Row vectors of B transposed
-			btb[j] = bt[j]*bt[j].transpose();                                           // Outer product of row vectors
-		}
 		
 		// Run the interior point method
 		for(int i = 0; i < this->steps; i++)
 		{
 			// (Re)set values for new loop
-			g.setZero();                                                                // Gradient vector
-			I = H;                                                                      // Hessian for log-barrier function
+			space.g.noalias() = H*space.x;                                              // Gradient vector
+			space.g += f;
+			space.I = H;                                                                // Hessian for log-barrier function
 			
 			// Compute distance to each constraint
 			for(int j = 0; j < numConstraints; j++)
 			{
-				d[j] = bt[j].dot(x) - z(j);                                         // Distance to jth constraint
+				space.d(j) = B.row(j).dot(space.x) - z(j);                          // Distance to jth constraint
 				
-				if(d[j] <= 0)
+				if(space.d(j) <= 0)
 				{
 					if(i == 0) throw std::runtime_error("[ERROR] [QP SOLVER] solve(): Start point x0 is outside the constraints!");
 		
-					d[j] = 1e-03;                                               // Set a small, non-zero value
+					space.d(j) = 1e-03;                                         // Set a small, non-zero value
 					u *= 100;                                                   // Increase the barrier function
 				}
-						
-				g += -(u/d[j])*bt[j];                                               // Add up gradient vector
-				I +=  (u/(d[j]*d[j]))*btb[j];                                       // Add up Hessian
+				
+				space.g.noalias() -= (u/space.d(j))*B.row(j).transpose();           // Add up gradient vector
+				
+				space.scaled = (u/(space.d(j)*space.d(j)))*B.row(j).transpose();
+				space.I.noalias() += space.scaled*B.row(j);                         // Add up Hessian
 			}
-			
-			g += H*x + f;                                                               // Finish summation of gradient vector
 
-			dx = I.partialPivLu().solve(-g);                                            // LU decomposition seems most stable
+			space.decomposition.compute(space.I);                                       // LU decomposition seems most stable
+			space.dx.noalias() = space.decomposition.solve(space.g);
+			space.dx *= -1;                                                             // Newton step = -I^-1*g
 			
 			// Ensure the next position is within the constraint
 			alpha = this->alpha0;                                                       // Reset the scalar for the step size
 			for(int j = 0; j < numConstraints; j++)
 			{
-				double dotProduct = bt[j].dot(dx);                                   // Makes things a little easier
+				double dotProduct = B.row(j).dot(space.dx);                          // Makes things a little easier
 				
-				if( d[j] + alpha*dotProduct < 0 )                                   // If constraint violated on next step...
+				if( space.d(j) + alpha*dotProduct < 0 )                             // If constraint violated on next step...
 				{
-					double temp = (1e-04 - d[j])/dotProduct;                     // Compute optimal scalar to avoid constraint violation
+					double temp = (1e-04 - space.d(j))/dotProduct;               // Compute optimal scalar to avoid constraint violation
 					
 					if(temp < alpha) alpha = temp;                              // If smaller, override
 				}
 			}
 
-			if(alpha*dx.norm() < this->tol) break;                                      // Change in position is insignificant; must be optimal
+			if(alpha*space.dx.norm() < this->tol) break;                                // Change in position is insignificant; must be optimal
 			
 			// Update values for next loop
-			x += alpha*dx;                                                              // Increment state
+			space.x += alpha*space.dx;                                                  // Increment state
 			u *= beta;                                                                  // Decrease barrier function
 		}
 			
-		this->lastSolution = x;                                                             // Save this value for future use
+		this->lastSolution = &space.x;                                                      // Save this value for future use
 		this->lastSolutionExists = true;                                                    // Flag that the interior point method has been run
 		
-		return x;
+		return space.x;
 	}
 }	
 
@@ -203,12 +192,12 @@ Eigen::VectorXd QPSolver::least_squares(const Eigen::VectorXd &y,
   ///////////////////////////////////////////////////////////////////////////////////////////////////
  //    Solve a constrained least squares problem 0.5*(y-A*x)'*W*(y-A*x) s.t. xMin <= x <= xMax    //
 ///////////////////////////////////////////////////////////////////////////////////////////////////                           
-Eigen::VectorXd QPSolver::least_squares(const Eigen::VectorXd &y,
-                                        const Eigen::MatrixXd &A,
-                                        const Eigen::MatrixXd &W,
-                                        const Eigen::VectorXd &xMin,
-                                        const Eigen::VectorXd &xMax,
-                                        const Eigen::VectorXd &x0)
+Eigen::Ref<const Eigen::VectorXd> QPSolver::least_squares(const Eigen::Ref<const Eigen::VectorXd> &y,
+                                                          const Eigen::Ref<const Eigen::MatrixXd> &A,
+                                                          const Eigen::Ref<const Eigen::MatrixXd> &W,
+                                                          const Eigen::Ref<const Eigen::VectorXd> &xMin,
+                                                          const Eigen::Ref<const Eigen::VectorXd> &xMax,
+                                                          const Eigen::Ref<const Eigen::VectorXd> &x0)
 {
 	if(W.rows() != W.cols())
 	{	
@@ -245,20 +234,27 @@ Eigen::VectorXd QPSolver::least_squares(const Eigen::VectorXd &y,
 	{
 		int n = x0.size();
 		
+		Workspace &space = workspace(n,2*n);
+		
 		// Set up constraint matrices in standard form Bx >= c where:
 		// B*x = [ -I ] >= [ -xMax ]
 		//       [  I ]    [  xMin ]
-		Eigen::MatrixXd B(2*n,n);
-		B.block(n,0,n,n).setIdentity();
-		B.block(0,0,n,n) = -B.block(n,0,n,n);
+		space.B.block(n,0,n,n).setIdentity();
+		space.B.block(0,0,n,n) = -space.B.block(n,0,n,n);
 
-		Eigen::VectorXd z(2*n);
-		z.head(n) = -xMax;
-		z.tail(n) =  xMin;
+		space.z.head(n) = -xMax;
+		space.z.tail(n) =  xMin;
 		
-		Eigen::MatrixXd AtW = A.transpose()*W;                                              // Makes calcs a little simpler
+		if(space.AtW.rows() != n or space.AtW.cols() != A.rows()) space.AtW.resize(n,A.rows()); // First time only
+		
+		space.AtW.noalias() = A.transpose()*W;                                              // Makes calcs a little simpler
+		
+		space.H.noalias() = space.AtW*A;
+		
+		space.f.setZero();
+		space.f.noalias() -= space.AtW*y;
 
-		return solve(AtW*A,-AtW*y, B, z, x0);                                               // Convert to standard form and solve
+		return solve(space.H, space.f, space.B, space.z, x0);                               // Convert to standard form and solve
 	}
 }
 
@@ -330,13 +326,13 @@ Eigen::VectorXd QPSolver::redundant_least_squares(const Eigen::VectorXd &xd,
   ///////////////////////////////////////////////////////////////////////////////////////////////////
  //     Solve a problem of the form min 0.5*(xd-x)'*W*(xd-x)  s.t. A*x = y, xMin <= x <= xMax     //
 ///////////////////////////////////////////////////////////////////////////////////////////////////  
-Eigen::VectorXd QPSolver::redundant_least_squares(const Eigen::VectorXd &xd,
-                                                  const Eigen::MatrixXd &W,
-                                                  const Eigen::VectorXd &y,
-                                                  const Eigen::MatrixXd &A,
-                                                  const Eigen::VectorXd &xMin,
-                                                  const Eigen::VectorXd &xMax,
-                                                  const Eigen::VectorXd &x0)
+Eigen::Ref<const Eigen::VectorXd> QPSolver::redundant_least_squares(const Eigen::Ref<const Eigen::VectorXd> &xd,
+                                                                    const Eigen::Ref<const Eigen::MatrixXd> &W,
+                                                                    const Eigen::Ref<const Eigen::VectorXd> &y,
+                                                                    const Eigen::Ref<const Eigen::MatrixXd> &A,
+                                                                    const Eigen::Ref<const Eigen::VectorXd> &xMin,
+                                                                    const Eigen::Ref<const Eigen::VectorXd> &xMax,
+                                                                    const Eigen::Ref<const Eigen::VectorXd> &x0)
 {
 	unsigned int m = y.size();
 	unsigned int n = x0.size();
@@ -380,37 +376,105 @@ Eigen::VectorXd QPSolver::redundant_least_squares(const Eigen::VectorXd &xd,
 		// Convert to standard form 0.5*x'*H*x + x'*f subject to B*x >= z
 		// where "x" is now [lambda' x' ]'
 		
+		Workspace &space = workspace(m+n,2*n);
+		
+		if(space.error.size() != m) reserve(n,2*n,m);                                       // First time only
+		
 		// H = [ 0  A ]
 		//     [ A' W ]
-		Eigen::MatrixXd H(m+n,m+n);
-		H.block(0,0,m,m).setZero();
-		H.block(0,m,m,n) = A;
-		H.block(m,0,n,m) = A.transpose();
-		H.block(m,m,n,n) = W;
+		space.H.block(0,0,m,m).setZero();
+		space.H.block(0,m,m,n) = A;
+		space.H.block(m,0,n,m) = A.transpose();
+		space.H.block(m,m,n,n) = W;
 		
 		// B = [ 0 -I ]
 		//     [ 0  I ]
-		Eigen::MatrixXd B(2*n,m+n);
-		B.block(0,0,2*n,m).setZero();
-		B.block(n,m,  n,n).setIdentity();
-		B.block(0,m,  n,n) = -B.block(n,m,n,n);
+		space.B.block(0,0,2*n,m).setZero();
+		space.B.block(n,m,  n,n).setIdentity();
+		space.B.block(0,m,  n,n) = -space.B.block(n,m,n,n);
 
 		// z = [ -xMax ]
 		//     [  xMin ]
-		Eigen::VectorXd z(2*n);
-		z.head(n) = -xMax;
-		z.tail(n) =  xMin;
+		space.z.head(n) = -xMax;
+		space.z.tail(n) =  xMin;
 
 		// f = [   -y  ]
 		//     [ -W*xd ]
-		Eigen::VectorXd f(m+n);
-		f.head(m) = -y;
-		f.tail(n) = -W*xd;
+		space.f.head(m) = -y;
+		space.f.tail(n).setZero();
+		space.f.tail(n).noalias() -= W*xd;
+		
+		// Start the Lagrange multipliers at (A*W^-1*A')^-1*(A*xd - y)
+		space.weightDecomposition.compute(W);
+		space.WinvAt.noalias() = space.weightDecomposition.solve(A.transpose());
+		space.AWinvAt.noalias() = A*space.WinvAt;
+		space.multiplierDecomposition.compute(space.AWinvAt);
 		
-		Eigen::VectorXd startPoint(m+n);
-		startPoint.head(m) = (A*W.partialPivLu().inverse()*A.transpose()).partialPivLu().solve(A*xd - y);
-		startPoint.tail(n) = x0;
+		space.error.noalias() = A*xd;
+		space.error -= y;
 		
-		return (solve(H,f,B,z,startPoint)).tail(n);                                         // Convert to standard form and solve
+		space.startPoint.head(m).noalias() = space.multiplierDecomposition.solve(space.error);
+		space.startPoint.tail(n) = x0;
+		
+		return solve(space.H,space.f,space.B,space.z,space.startPoint).tail(n);             // Convert to standard form and solve
 	}
 }                  
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////////
+ //                    Allocate the storage for a problem of the given size                       //
+///////////////////////////////////////////////////////////////////////////////////////////////////
+void QPSolver::reserve(const unsigned int &numVariables,
+                       const unsigned int &numConstraints,
+                       const unsigned int &numEqualities)
+{
+	if(numEqualities == 0) workspace(numVariables, numConstraints);
+	else
+	{
+		// redundant_least_squares() adds the Lagrange multipliers to the decision variable
+		unsigned int m = numEqualities;
+		unsigned int n = numVariables;
+		
+		Workspace &space = workspace(m+n, numConstraints);
+		
+		space.WinvAt.resize(n,m);
+		space.AWinvAt.resize(m,m);
+		space.error.resize(m);
+		space.weightDecomposition     = Eigen::PartialPivLU<Eigen::MatrixXd>(n);
+		space.multiplierDecomposition = Eigen::PartialPivLU<Eigen::MatrixXd>(m);
+	}
+}
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////////
+ //             Find the storage for a problem of this size, or make it the first time            //
+///////////////////////////////////////////////////////////////////////////////////////////////////
+QPSolver::Workspace& QPSolver::workspace(const unsigned int &numVariables, const unsigned int &numConstraints)
+{
+	for(auto &space : this->workspaces)
+	{
+		if(space.numVariables == numVariables and space.numConstraints == numConstraints) return space;
+	}
+	
+	this->workspaces.emplace_back(numVariables, numConstraints);
+	
+	return this->workspaces.back();
+}
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                Constructor for the workspace                                  //
+///////////////////////////////////////////////////////////////////////////////////////////////////
+QPSolver::Workspace::Workspace(const unsigned int &_numVariables, const unsigned int &_numConstraints)
+                               :
+                               numVariables(_numVariables),
+                               numConstraints(_numConstraints),
+                               I(_numVariables,_numVariables),
+                               g(_numVariables),
+                               dx(_numVariables),
+                               x(_numVariables),
+                               scaled(_numVariables),
+                               d(_numConstraints),
+                               decomposition(_numVariables),
+                               H(_numVariables,_numVariables),
+                               B(_numConstraints,_numVariables),
+                               f(_numVariables),
+                               z(_numConstraints),
+                               startPoint(_numVariables) {}
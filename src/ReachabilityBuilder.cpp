@@ -0,0 +1,164 @@
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+   //                                                                                                //
+  //           Sample the joint space on every core and map where each hand can reach               //
+ //                                                                                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>                                                                                   // std::chrono::steady_clock
+#include <iDynTree/KinDynComputations.h>                                                            // Forward kinematics
+#include <iostream>                                                                                 // std::cerr, std::cout
+#include <random>                                                                                   // std::mt19937
+#include <ReachabilityMap.h>                                                                        // The map
+#include <RobotModel.h>                                                                             // load_robot_model()
+#include <thread>                                                                                   // std::thread
+#include <Utilities.h>                                                                              // string_from_bottle(), vector_from_bottle()
+#include <yarp/os/Property.h>                                                                       // Load configuration files
+
+int main(int argc, char* argv[])
+{
+	std::string errorMessage = "[ERROR] [REACHABILITY BUILDER] ";
+
+	if(argc != 4)
+	{
+		std::cerr << errorMessage << "Paths to the URDF, the config file and the output are required. "
+		          << "Usage: ./reachability_builder /path/to/model.urdf /path/to/config.ini /path/to/reachability.map\n";
+
+		return 1;
+	}
+
+	yarp::os::Property parameter; parameter.fromConfigFile(argv[2]);
+
+	yarp::os::Bottle *bottle = parameter.find("joint_names").asList();
+
+	if(bottle == nullptr)
+	{
+		std::cerr << errorMessage << "No list of joint names was specified in " << argv[2] << ".\n";
+
+		return 1;
+	}
+
+	std::vector<std::string> jointNames = string_from_bottle(bottle);
+
+	// The box to map, and how finely
+	yarp::os::Bottle *group = &parameter.findGroup("REACHABILITY");
+
+	if(group->isNull()
+	or group->find("lower").asList() == nullptr
+	or group->find("upper").asList() == nullptr)
+	{
+		std::cerr << errorMessage << "The REACHABILITY group in " << argv[2] << " needs 'lower' and 'upper' corners.\n";
+
+		return 1;
+	}
+
+	Eigen::VectorXd lower = vector_from_bottle(group->find("lower").asList());
+	Eigen::VectorXd upper = vector_from_bottle(group->find("upper").asList());
+
+	if(lower.size() != 3 or upper.size() != 3)
+	{
+		std::cerr << errorMessage << "The 'lower' and 'upper' corners must have 3 elements.\n";
+
+		return 1;
+	}
+
+	double resolution    = group->check("resolution", yarp::os::Value(0.02)).asFloat64();
+	long long numSamples = group->check("samples",    yarp::os::Value(2000000)).asInt64();
+	unsigned int numThreads = group->check("threads", yarp::os::Value(0)).asInt32();
+
+	if(numThreads == 0) numThreads = std::max(1U, std::thread::hardware_concurrency());         // Use every core
+
+	try
+	{
+		iDynTree::Transform basePose;
+
+		iDynTree::Model model = load_robot_model(argv[1], jointNames, parameter.find("model_name").asString(), basePose);
+
+		// Sample within the limits in the URDF
+		unsigned int n = model.getNrOfDOFs();
+
+		std::vector<std::array<double,2>> limit(n, {{-M_PI, M_PI}});
+
+		for(unsigned int i = 0; i < n; i++)
+		{
+			if(model.getJoint(i)->hasPosLimits()) model.getJoint(i)->getPosLimits(0, limit[i][0], limit[i][1]);
+		}
+
+		// Each thread fills its own map, so nothing is shared until they are merged
+		std::vector<ReachabilityMap> maps(numThreads, ReachabilityMap(lower, upper, resolution));
+
+		auto start = std::chrono::steady_clock::now();
+
+		auto worker = [&](const unsigned int thread)
+		{
+			iDynTree::KinDynComputations computer;
+			computer.loadRobotModel(model);
+
+			std::mt19937 generator(thread);                                             // Same map every time
+			std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+			iDynTree::VectorDynSize jointPosition(n), jointVelocity(n);
+			jointVelocity.zero();
+
+			Eigen::MatrixXd jacobian(6, 6 + n);
+			Eigen::Matrix<double,6,6> JJt;
+
+			const std::string frame[2] = {"left", "right"};
+
+			for(long long k = thread; k < numSamples; k += numThreads)
+			{
+				for(unsigned int i = 0; i < n; i++)
+				{
+					jointPosition(i) = limit[i][0] + unit(generator)*(limit[i][1] - limit[i][0]);
+				}
+
+				computer.setRobotState(basePose,
+				                       jointPosition,
+				                       iDynTree::Twist(iDynTree::GeomVector3(0,0,0), iDynTree::GeomVector3(0,0,0)),
+				                       jointVelocity,
+				                       iDynTree::Vector3(std::vector<double> {0.0, 0.0, -9.81}));
+
+				for(int hand = 0; hand < 2; hand++)
+				{
+					computer.getFrameFreeFloatingJacobian(frame[hand], jacobian);
+
+					JJt = jacobian.rightCols(n)*jacobian.rightCols(n).transpose();
+
+					iDynTree::Position position = computer.getWorldTransform(frame[hand]).getPosition();
+
+					maps[thread].add(static_cast<ReachabilityMap::Hand>(hand),
+					                 Eigen::Vector3d(position[0], position[1], position[2]),
+					                 sqrt(std::max(JJt.determinant(), 0.0)));   // Manipulability
+				}
+			}
+		};
+
+		std::vector<std::thread> threads;
+
+		for(unsigned int i = 0; i < numThreads; i++) threads.emplace_back(worker, i);
+
+		for(auto &thread : threads) thread.join();
+
+		for(unsigned int i = 1; i < numThreads; i++) maps[0].merge(maps[i]);
+
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		if(not maps[0].save(argv[3])) return 1;
+
+		ReachabilityMap check;                                                              // Make sure it reads back
+
+		if(not check.load(argv[3])) return 1;
+
+		std::cout << "[INFO] [REACHABILITY BUILDER] Sampled " << numSamples << " configurations on "
+		          << numThreads << " threads in " << elapsed << " s. The left hand reached "
+		          << check.reachable_voxels(ReachabilityMap::left) << " voxels and the right hand reached "
+		          << check.reachable_voxels(ReachabilityMap::right) << ". Saved to " << argv[3] << ".\n";
+	}
+	catch(const std::exception &exception)
+	{
+		std::cerr << exception.what() << std::endl;
+
+		return 1;
+	}
+
+	return 0;
+}
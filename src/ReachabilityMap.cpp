@@ -0,0 +1,329 @@
+#include <ReachabilityMap.h>
+
+#include <cmath>                                                                                    // std::floor, std::ceil
+#include <cstring>                                                                                  // std::memcmp, std::memcpy
+#include <fstream>                                                                                  // std::ifstream, std::ofstream
+#include <iostream>                                                                                 // std::cerr
+#include <stdexcept>                                                                                // std::invalid_argument
+
+static const char     reachabilityMagic[8] = "ICUBRCH";
+static const uint32_t reachabilityVersion  = 1;
+static const uint32_t byteOrderMarker      = 0x01020304;
+static const uint64_t maxVoxels            = 1 << 28;                                               // 256 MB per hand as floats
+
+static_assert(sizeof(ReachabilityFileHeader) == 72, "The reachability file layout has changed");
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                         Constructor                                            //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+ReachabilityMap::ReachabilityMap(const Eigen::Vector3d &_lower,
+                                 const Eigen::Vector3d &upper,
+                                 const double          &_resolution)
+                                 :
+                                 lower(_lower),
+                                 resolution(_resolution)
+{
+	std::string message = "[ERROR] [REACHABILITY MAP] Constructor: ";
+
+	if(this->resolution <= 0)
+	{
+		throw std::invalid_argument(message + "Resolution must be positive but it was "
+		                            + std::to_string(this->resolution) + ".");
+	}
+
+	uint64_t numVoxels = 1;
+
+	for(int i = 0; i < 3; i++)
+	{
+		if(upper(i) <= this->lower(i))
+		{
+			throw std::invalid_argument(message + "The upper corner must be above the lower corner along every axis.");
+		}
+
+		this->size[i] = std::ceil((upper(i) - this->lower(i))/this->resolution);
+
+		numVoxels *= this->size[i];
+	}
+
+	if(numVoxels > maxVoxels)
+	{
+		throw std::invalid_argument(message + "The map would have " + std::to_string(numVoxels) + " voxels, "
+		                            "but the limit is " + std::to_string(maxVoxels) + ". Use a coarser resolution.");
+	}
+
+	this->voxels[left].assign(numVoxels, 0.0);
+	this->voxels[right].assign(numVoxels, 0.0);
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                          Record that a hand reached a position                                 //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ReachabilityMap::add(const Hand &hand, const Eigen::Vector3d &position, const double &manipulability)
+{
+	std::array<int,3> cell;
+
+	if(not index(position, cell)) return;                                                       // Outside the map
+
+	float &voxel = this->voxels[hand][flatten(cell)];
+
+	if(manipulability > voxel) voxel = manipulability;
+
+	if(manipulability > this->best[hand]) this->best[hand] = manipulability;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                    Combine with a map of the same box, keeping the best of each                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool ReachabilityMap::merge(const ReachabilityMap &other)
+{
+	if(other.size != this->size or other.lower != this->lower or other.resolution != this->resolution)
+	{
+		std::cerr << "[ERROR] [REACHABILITY MAP] merge(): The maps do not cover the same voxels.\n";
+
+		return false;
+	}
+
+	for(int hand = 0; hand < 2; hand++)
+	{
+		for(size_t i = 0; i < this->voxels[hand].size(); i++)
+		{
+			if(other.voxels[hand][i] > this->voxels[hand][i]) this->voxels[hand][i] = other.voxels[hand][i];
+		}
+
+		if(other.best[hand] > this->best[hand]) this->best[hand] = other.best[hand];
+	}
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                        How well a hand can reach a position, from 0 to 1                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+double ReachabilityMap::score(const Hand &hand, const Eigen::Vector3d &position) const
+{
+	std::array<int,3> cell;
+
+	if(this->best[hand] <= 0 or not index(position, cell)) return 0.0;
+
+	return this->voxels[hand][flatten(cell)]/this->best[hand];
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //          Search outward, one shell of voxels at a time, for the closest reachable one          //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool ReachabilityMap::nearest_reachable(const Hand            &hand,
+                                        const Eigen::Vector3d &position,
+                                        const double          &maxDistance,
+                                        Eigen::Vector3d       &nearest) const
+{
+	if(is_empty() or this->best[hand] <= 0) return false;
+
+	// The cell the position is in, even if it is outside the map
+	std::array<int,3> middle;
+	for(int i = 0; i < 3; i++) middle[i] = std::floor((position(i) - this->lower(i))/this->resolution);
+
+	int maxShell = std::ceil(maxDistance/this->resolution);
+
+	double closest = maxDistance;
+	bool found = false;
+
+	for(int shell = 0; shell <= maxShell; shell++)
+	{
+		for(int dz = -shell; dz <= shell; dz++)
+		{
+			for(int dy = -shell; dy <= shell; dy++)
+			{
+				for(int dx = -shell; dx <= shell; dx++)
+				{
+					if(std::max(std::abs(dx), std::max(std::abs(dy), std::abs(dz))) != shell) continue; // Inner shells are done
+
+					std::array<int,3> cell = {{middle[0] + dx, middle[1] + dy, middle[2] + dz}};
+
+					if(cell[0] < 0 or cell[0] >= (int)this->size[0]
+					or cell[1] < 0 or cell[1] >= (int)this->size[1]
+					or cell[2] < 0 or cell[2] >= (int)this->size[2]
+					or this->voxels[hand][flatten(cell)] <= 0) continue;
+
+					double distance = (centre(cell) - position).norm();
+
+					if(distance <= closest)
+					{
+						closest = distance;
+						nearest = centre(cell);
+						found   = true;
+					}
+				}
+			}
+		}
+
+		if(found and closest <= shell*this->resolution) return true;                        // Nothing further out can be closer
+	}
+
+	return found;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                              Number of voxels a hand can reach                                 //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+unsigned int ReachabilityMap::reachable_voxels(const Hand &hand) const
+{
+	unsigned int count = 0;
+
+	for(const float &voxel : this->voxels[hand]) if(voxel > 0) count++;
+
+	return count;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                               Find the voxel that contains a position                          //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool ReachabilityMap::index(const Eigen::Vector3d &position, std::array<int,3> &cell) const
+{
+	for(int i = 0; i < 3; i++)
+	{
+		double offset = (position(i) - this->lower(i))/this->resolution;
+
+		if(offset < 0 or offset >= this->size[i]) return false;
+
+		cell[i] = offset;
+	}
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                    Write the map to a file                                     //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool ReachabilityMap::save(const std::string &path) const
+{
+	if(is_empty())
+	{
+		std::cerr << "[ERROR] [REACHABILITY MAP] save(): There is nothing in the map.\n";
+
+		return false;
+	}
+
+	ReachabilityFileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, reachabilityMagic, sizeof(reachabilityMagic));
+	header.version    = reachabilityVersion;
+	header.byteOrder  = byteOrderMarker;
+	header.resolution = this->resolution;
+
+	for(int i = 0; i < 3; i++)
+	{
+		header.size[i]  = this->size[i];
+		header.lower[i] = this->lower(i);
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	// Store each voxel as a fraction of the best in 1 byte
+	std::vector<uint8_t> scores(this->voxels[left].size());
+
+	for(int hand = 0; hand < 2; hand++)
+	{
+		header.scale[hand] = this->best[hand];
+
+		for(size_t i = 0; i < scores.size(); i++)
+		{
+			scores[i] = this->best[hand] > 0 ? std::lround(255*this->voxels[hand][i]/this->best[hand]) : 0;
+		}
+
+		file.write(reinterpret_cast<const char*>(scores.data()), scores.size());
+	}
+
+	file.seekp(0);                                                                              // Now the scales are known
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	if(not file)
+	{
+		std::cerr << "[ERROR] [REACHABILITY MAP] save(): Could not write to " << path << ".\n";
+
+		return false;
+	}
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                   Read the map from a file                                     //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool ReachabilityMap::load(const std::string &path)
+{
+	std::ifstream file(path, std::ios::binary);
+
+	ReachabilityFileHeader header;
+
+	if(not file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+	{
+		std::cerr << "[ERROR] [REACHABILITY MAP] load(): Could not read a header from " << path << ".\n";
+
+		return false;
+	}
+
+	std::string problem;                                                                        // Empty if the file is good
+
+	uint64_t numVoxels = (uint64_t)header.size[0]*header.size[1]*header.size[2];
+
+	if(std::memcmp(header.magic, reachabilityMagic, sizeof(reachabilityMagic)) != 0)
+	{
+		problem = "it is not a reachability map";
+	}
+	else if(header.byteOrder != byteOrderMarker)
+	{
+		problem = "it was written on a machine with the opposite byte order";
+	}
+	else if(header.version != reachabilityVersion)
+	{
+		problem = "it is version " + std::to_string(header.version) + " but version "
+		        + std::to_string(reachabilityVersion) + " is required";
+	}
+	else if(numVoxels == 0 or numVoxels > maxVoxels or not (header.resolution > 0))
+	{
+		problem = "the size of the map is invalid";
+	}
+
+	std::vector<uint8_t> scores;
+
+	if(problem.empty())
+	{
+		scores.resize(2*numVoxels);                                                         // Left, then right
+
+		if(not file.read(reinterpret_cast<char*>(scores.data()), scores.size()))
+		{
+			problem = "the file is shorter than the map it describes";
+		}
+	}
+
+	if(not problem.empty())
+	{
+		std::cerr << "[ERROR] [REACHABILITY MAP] load(): Could not load " << path << " because " << problem << ".\n";
+
+		return false;
+	}
+
+	for(int i = 0; i < 3; i++)
+	{
+		this->size[i]  = header.size[i];
+		this->lower(i) = header.lower[i];
+	}
+
+	this->resolution = header.resolution;
+
+	for(int hand = 0; hand < 2; hand++)
+	{
+		this->voxels[hand].resize(numVoxels);
+
+		this->best[hand] = header.scale[hand];
+
+		for(uint64_t i = 0; i < numVoxels; i++)
+		{
+			this->voxels[hand][i] = scores[hand*numVoxels + i]*header.scale[hand]/255;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,125 @@
+#include <RealTime.h>
+#include <algorithm>                                                                                // std::min
+#include <alloca.h>                                                                                 // alloca
+#include <cerrno>                                                                                   // errno
+#include <cstring>                                                                                  // std::strerror
+#include <malloc.h>                                                                                 // mallopt
+#include <pthread.h>                                                                                // pthread_setschedparam, pthread_setaffinity_np
+#include <sched.h>                                                                                  // SCHED_FIFO, cpu_set_t
+#include <sys/mman.h>                                                                               // mlockall
+#include <unistd.h>                                                                                 // sysconf
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                           Get the REAL_TIME group from the config file                         //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool load_real_time_options(const yarp::os::Bottle *bottle, RealTimeOptions &options)
+{
+	if(bottle == nullptr or bottle->isNull()) return true;                                      // Not listed, so use the defaults
+
+	options.priority      = bottle->check("priority",       yarp::os::Value(options.priority)).asInt32();
+	options.cpu           = bottle->check("cpu",            yarp::os::Value(options.cpu)).asInt32();
+	options.lockMemory    = bottle->check("lock_memory",    yarp::os::Value((int)options.lockMemory)).asInt32() != 0;
+	int stackPrefault     = bottle->check("stack_prefault", yarp::os::Value((int)options.stackPrefault)).asInt32();
+
+	if(options.priority < 0 or options.priority > 99)
+	{
+		std::cerr << "[ERROR] load_real_time_options(): Priority must be between 0 and 99 but it was "
+		          << options.priority << ".\n";
+
+		return false;
+	}
+	else if(options.cpu >= sysconf(_SC_NPROCESSORS_CONF))
+	{
+		std::cerr << "[ERROR] load_real_time_options(): CPU " << options.cpu << " was requested but "
+		          << "this computer only has " << sysconf(_SC_NPROCESSORS_CONF) << ".\n";
+
+		return false;
+	}
+	else if(stackPrefault < 0 or stackPrefault > (int)maxStackPrefault)
+	{
+		std::cerr << "[ERROR] load_real_time_options(): Stack prefault must be between 0 and "
+		          << maxStackPrefault << " bytes but it was " << stackPrefault << ".\n";
+
+		return false;
+	}
+
+	options.stackPrefault = stackPrefault;                                                      // alloca() on the control thread, so keep it small
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                        Lock all current and future memory pages in to RAM                      //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool lock_process_memory()
+{
+	if(mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+	{
+		std::cerr << "[ERROR] lock_process_memory(): mlockall() failed: " << std::strerror(errno)
+		          << ". Is RLIMIT_MEMLOCK large enough?\n";
+
+		return false;
+	}
+
+	// Keep freed memory in the process, otherwise it gets handed back and faulted in again later
+	mallopt(M_TRIM_THRESHOLD, -1);
+	mallopt(M_MMAP_MAX, 0);
+	
+	std::cout << "[INFO] Memory locked.\n";
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                  Apply the scheduling options to whichever thread calls this                   //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool configure_current_thread(const RealTimeOptions &options)
+{
+	bool success = true;
+
+	if(options.cpu >= 0)
+	{
+		cpu_set_t cpuSet;
+		CPU_ZERO(&cpuSet);
+		CPU_SET(options.cpu, &cpuSet);
+
+		int error = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet);
+
+		if(error != 0)
+		{
+			std::cerr << "[ERROR] configure_current_thread(): Could not pin the thread to CPU "
+			          << options.cpu << ": " << std::strerror(error) << ".\n";
+
+			success = false;
+		}
+	}
+
+	if(options.priority > 0)
+	{
+		sched_param parameter;
+		parameter.sched_priority = options.priority;
+
+		int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameter);
+
+		if(error != 0)
+		{
+			std::cerr << "[ERROR] configure_current_thread(): Could not set SCHED_FIFO priority "
+			          << options.priority << ": " << std::strerror(error) << ". "
+			          << "Does this user have CAP_SYS_NICE or an rtprio limit?\n";
+
+			success = false;
+		}
+	}
+
+	if(options.lockMemory and options.stackPrefault > 0)
+	{
+		// Touch the stack now so the page faults don't happen in the middle of a control step
+		unsigned int size = std::min(options.stackPrefault, maxStackPrefault);              // Also capped if set in code
+
+		volatile unsigned char *stack = (volatile unsigned char*)alloca(size);
+
+		for(unsigned int i = 0; i < size; i += 4096) stack[i] = 0;
+	}
+
+	return success;
+}
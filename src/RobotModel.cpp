@@ -0,0 +1,218 @@
+#include <RobotModel.h>
+
+#include <array>                                                                                    // std::array
+#include <chrono>                                                                                   // std::chrono::steady_clock
+#include <cstdint>                                                                                  // uint64_t
+#include <cstdio>                                                                                   // std::rename()
+#include <cstdlib>                                                                                  // std::getenv()
+#include <fstream>                                                                                  // std::ifstream, std::ofstream
+#include <iDynTree/ModelIO/ModelExporter.h>                                                         // Writes the reduced model back out
+#include <iostream>                                                                                 // std::cout
+#include <sstream>                                                                                  // std::stringstream
+#include <stdexcept>                                                                                // std::runtime_error
+#include <sys/stat.h>                                                                               // mkdir()
+#include <unistd.h>                                                                                 // getpid()
+
+static const std::string modelCacheVersion = "1";                                                   // Change if the cached form changes
+
+// A frame added to a link of the URDF
+struct HandFrame
+{
+	std::string link;
+	std::string name;
+	double rpy[3];
+	double xyz[3];
+};
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                       The hand frames and the pose of the base for each robot                  //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+static std::array<HandFrame,2> hand_frames(const std::string &robotModel, iDynTree::Transform &basePose)
+{
+	std::string message = "[ERROR] load_robot_model(): ";
+
+	if(robotModel == "iCub2")
+	{
+		basePose = iDynTree::Transform(iDynTree::Rotation::RPY(0,0,-M_PI),
+		                               iDynTree::Position(0,0,0));
+
+		return {{ {"l_hand", "left",  {0.0, 0.0, 0.0},  { 0.05765, -0.00556, 0.01369}},
+		          {"r_hand", "right", {0.0, 0.0, M_PI}, {-0.05765, -0.00556, 0.01369}} }};
+	}
+	else if(robotModel == "iCub3")
+	{
+		throw std::runtime_error(message + "Hand transforms for iCub3 have not been programmed yet!");
+	}
+	else if(robotModel == "ergoCub")
+	{
+		basePose = iDynTree::Transform(iDynTree::Rotation::RPY(0,0,0),
+		                               iDynTree::Position(0,0,0));
+
+		return {{ {"l_hand_palm", "left",  {0.0, M_PI/2, 0.0}, {-0.00346,  0.00266, -0.0592}},
+		          {"r_hand_palm", "right", {0.0, M_PI/2, 0.0}, {-0.00387, -0.00280, -0.0597}} }};
+	}
+	else
+	{
+		throw std::invalid_argument(message + "Expected 'iCub2', 'iCub3' or 'ergoCub' for the robot model argument, "
+		                            "but your input was '" + robotModel + "'.");
+	}
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                     Where to keep the cached models (empty if there isn't anywhere)            //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+static std::string model_cache_directory()
+{
+	const char *path = std::getenv("ICUB_BIMANUAL_CACHE");                                      // Set it empty to turn the cache off
+
+	if(path != nullptr) return path;
+
+	path = std::getenv("XDG_CACHE_HOME");
+
+	if(path != nullptr and path[0] != '\0') return std::string(path) + "/icub-bimanual";
+
+	path = std::getenv("HOME");
+
+	if(path != nullptr and path[0] != '\0') return std::string(path) + "/.cache/icub-bimanual";
+
+	return "";
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                   64-bit FNV-1a hash of some bytes                             //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+static uint64_t fnv1a(const void *data, const size_t &size, uint64_t hash = 14695981039346656037ULL)
+{
+	const unsigned char *byte = static_cast<const unsigned char*>(data);
+
+	for(size_t i = 0; i < size; i++)
+	{
+		hash ^= byte[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //             Load the joints from the URDF, and add the hand frames for this robot              //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+iDynTree::Model load_robot_model(const std::string              &pathToURDF,
+                                 const std::vector<std::string> &jointList,
+                                 const std::string              &robotModel,
+                                 iDynTree::Transform            &basePose)
+{
+	std::string message = "[ERROR] load_robot_model(): ";
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::array<HandFrame,2> frames = hand_frames(robotModel, basePose);
+
+	// Everything the reduced model depends on goes in to the key: the whole URDF, the joints in
+	// order, the hand frames, and the version of the cache
+	std::ifstream urdf(pathToURDF, std::ios::binary);
+
+	std::stringstream contents; contents << urdf.rdbuf();
+
+	if(not urdf)
+	{
+		throw std::runtime_error(message + "Could not load model from the path " + pathToURDF + ".");
+	}
+
+	uint64_t key = fnv1a(contents.str().data(), contents.str().size());
+
+	for(const std::string &joint : jointList) key = fnv1a(joint.c_str(), joint.size() + 1, key); // Include the '\0' between names
+
+	for(const HandFrame &frame : frames)
+	{
+		key = fnv1a(frame.link.c_str(), frame.link.size() + 1, key);
+		key = fnv1a(frame.name.c_str(), frame.name.size() + 1, key);
+		key = fnv1a(frame.rpy, sizeof(frame.rpy), key);
+		key = fnv1a(frame.xyz, sizeof(frame.xyz), key);
+	}
+
+	key = fnv1a(modelCacheVersion.c_str(), modelCacheVersion.size(), key);
+
+	std::string directory = model_cache_directory();
+
+	std::stringstream cacheFile;
+	cacheFile << directory << "/model_" << std::hex << key << ".urdf";
+
+	iDynTree::ModelLoader loader;
+
+	// Use the cached copy if there is one; it only has the joints & frames we need, so it is quick to parse
+	if(not directory.empty())
+	{
+		std::ifstream cached(cacheFile.str(), std::ios::binary);
+
+		std::stringstream cachedContents; cachedContents << cached.rdbuf();
+
+		if(cached
+		and loader.loadReducedModelFromString(cachedContents.str(), jointList, "urdf")
+		and loader.model().isFrameNameUsed(frames[0].name)
+		and loader.model().isFrameNameUsed(frames[1].name))
+		{
+			std::cout << "[INFO] load_robot_model(): Loaded the model from " << cacheFile.str() << " in "
+			          << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s.\n";
+
+			return loader.model();
+		}
+	}
+
+	// Otherwise parse the full URDF and add the hand frames
+	if(not loader.loadReducedModelFromFile(pathToURDF, jointList, "urdf"))
+	{
+		throw std::runtime_error(message + "Could not load model from the path " + pathToURDF + ".");
+	}
+
+	iDynTree::Model model = loader.model();
+
+	for(const HandFrame &frame : frames)
+	{
+		model.addAdditionalFrameToLink(frame.link, frame.name,
+		                               iDynTree::Transform(iDynTree::Rotation::RPY(frame.rpy[0], frame.rpy[1], frame.rpy[2]),
+		                                                   iDynTree::Position(frame.xyz[0], frame.xyz[1], frame.xyz[2])));
+	}
+
+	std::cout << "[INFO] load_robot_model(): Loaded the model from " << pathToURDF << " in "
+	          << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s.\n";
+
+	// Save it for next time. Failing to is not a problem, it just means the next start is slower
+	if(not directory.empty())
+	{
+		iDynTree::ModelExporter exporter;
+		std::string reduced;
+
+		// Make the directories, one level at a time
+		for(size_t slash = directory.find('/', 1); ; slash = directory.find('/', slash + 1))
+		{
+			mkdir(directory.substr(0, slash).c_str(), 0755);
+
+			if(slash == std::string::npos) break;
+		}
+
+		std::string temporary = cacheFile.str() + "." + std::to_string(getpid());           // Other servers might be starting too
+
+		bool saved = exporter.init(model) and exporter.exportModelToString(reduced, "urdf");
+
+		if(saved)
+		{
+			std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+
+			file.write(reduced.data(), reduced.size());
+			file.close();
+
+			saved = not file.fail() and std::rename(temporary.c_str(), cacheFile.str().c_str()) == 0; // Appears all at once
+		}
+
+		if(saved) std::cout << "[INFO] load_robot_model(): Saved the reduced model to " << cacheFile.str() << ".\n";
+		else
+		{
+			std::remove(temporary.c_str());
+
+			std::cout << "[WARNING] load_robot_model(): Could not save the reduced model to " << cacheFile.str() << ".\n";
+		}
+	}
+
+	return model;
+}
@@ -0,0 +1,136 @@
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+   //                                                                                                //
+  //        Compares reading the encoders one joint at a time with reading them all in one call     //
+ //                                                                                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>                                                                                   // std::chrono::steady_clock
+#include <iostream>                                                                                 // std::cout, std::cerr
+#include <LoopTimer.h>                                                                              // TimingHistogram
+#include <sstream>                                                                                  // std::stringstream
+#include <string>                                                                                   // std::stoi
+#include <Utilities.h>                                                                              // string_from_bottle()
+#include <vector>                                                                                   // std::vector
+#include <yarp/dev/ControlBoardInterfaces.h>                                                        // yarp::dev::IEncodersTimed
+#include <yarp/dev/PolyDriver.h>                                                                    // yarp::dev::PolyDriver
+#include <yarp/os/Network.h>                                                                        // yarp::os::Network
+#include <yarp/os/Property.h>                                                                       // yarp::os::Property
+
+using Clock = std::chrono::steady_clock;
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                             One row of the table, in milliseconds                              //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+std::string row(const std::string &name, const TimingHistogram &histogram)
+{
+	std::stringstream stream;
+
+	stream.precision(3);
+	stream << std::fixed;
+
+	stream.width(12); stream << std::left  << name << " ";
+	stream.width(10); stream << std::right << histogram.count() << " ";
+	stream.width(10); stream << histogram.percentile(0.50)*1000 << " ";
+	stream.width(10); stream << histogram.percentile(0.99)*1000 << " ";
+	stream.width(10); stream << histogram.max()*1000 << "\n";
+
+	return stream.str();
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                             MAIN                                               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+	std::string errorMessage = "[ERROR] [SENSING BENCHMARK] ";
+
+	if(argc != 4)
+	{
+		std::cerr << errorMessage << "Robot port prefix, path to config file and number of samples are required. "
+		          << "Usage: ./sensing_benchmark /icubSim /path/to/config.ini 5000\n";
+
+		return 1;
+	}
+
+	std::string robotPortPrefix = argv[1];
+	std::string pathToConfig    = argv[2];
+	int samples                 = std::stoi(argv[3]);
+
+	yarp::os::Network yarp;
+
+	yarp::os::Property parameter; parameter.fromConfigFile(pathToConfig);
+
+	yarp::os::Bottle *list = parameter.find("joint_names").asList();
+
+	if(list == nullptr)
+	{
+		std::cerr << errorMessage << "No list of joint names was specified in " << pathToConfig << ".\n";
+
+		return 1;
+	}
+
+	std::vector<std::string> jointList = string_from_bottle(list);
+
+	// Same control boards & options as JointInterface, so the calls go through the same remapper
+	yarp::os::Property options;
+	options.put("device", "remotecontrolboardremapper");
+	options.addGroup("axesNames");
+
+	yarp::os::Bottle &names = options.findGroup("axesNames").addList();
+	for(const std::string &name : jointList) names.addString(name);
+
+	yarp::os::Bottle remoteControlBoards;
+	yarp::os::Bottle &remoteControlBoardsList = remoteControlBoards.addList();
+	remoteControlBoardsList.addString(robotPortPrefix + "/torso");
+	remoteControlBoardsList.addString(robotPortPrefix + "/left_arm");
+	remoteControlBoardsList.addString(robotPortPrefix + "/right_arm");
+
+	options.put("remoteControlBoards", remoteControlBoards.get(0));
+	options.put("localPortPrefix", "/sensing_benchmark");
+
+	yarp::dev::PolyDriver driver;
+	yarp::dev::IEncodersTimed *encoders = nullptr;
+
+	if(not driver.open(options) or not driver.view(encoders))
+	{
+		std::cerr << errorMessage << "Could not connect to the encoders on " << robotPortPrefix << ".\n";
+
+		return 1;
+	}
+
+	int numJoints = jointList.size();
+
+	std::vector<double> position(numJoints), velocity(numJoints), time(numJoints);
+
+	TimingHistogram perJoint, bulk;
+
+	// Alternate the two so they both see the same load from the simulator
+	for(int k = 0; k < samples; k++)
+	{
+		Clock::time_point start = Clock::now();
+
+		for(int i = 0; i < numJoints; i++)
+		{
+			encoders->getEncoder     (i, &position[i]);
+			encoders->getEncoderSpeed(i, &velocity[i]);
+		}
+
+		perJoint.record(std::chrono::duration<double>(Clock::now() - start).count());
+
+		start = Clock::now();
+
+		encoders->getEncodersTimed(position.data(), time.data());
+		encoders->getEncoderSpeeds(velocity.data());
+
+		bulk.record(std::chrono::duration<double>(Clock::now() - start).count());
+	}
+
+	driver.close();
+
+	std::cout << "\nReading " << numJoints << " joints from " << robotPortPrefix << ":\n"
+	          << "method       count      p50 (ms)   p99 (ms)   max (ms)\n"
+	          << row("per joint", perJoint)
+	          << row("bulk", bulk);
+
+	return 0;
+}
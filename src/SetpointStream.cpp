@@ -0,0 +1,163 @@
+#include <SetpointStream.h>
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                  Open the port and start listening                             //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool SetpointStream::open(const std::string &portName)
+{
+	if(not this->port.open(portName))
+	{
+		std::cerr << "[ERROR] [SETPOINT STREAM] open(): Could not open the port " << portName << ".\n";
+
+		return false;
+	}
+
+	this->port.useCallback(*this);                                                              // onRead() is called for every message
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                          Stop listening                                        //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void SetpointStream::close()
+{
+	this->port.disableCallback();
+
+	this->port.close();
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                       Convert a message to a setpoint and put it in the queue                  //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void SetpointStream::onRead(yarp::os::Bottle &bottle)
+{
+	if(bottle.size() != 7 and bottle.size() != 13)
+	{
+		this->rejectedCount.fetch_add(1, std::memory_order_relaxed);
+
+		return;
+	}
+
+	std::vector<double> numbers(bottle.size());
+
+	for(int i = 0; i < bottle.size(); i++)
+	{
+		yarp::os::Value value = bottle.get(i);
+
+		     if(value.isFloat64()) numbers[i] = value.asFloat64();
+		else if(value.isInt32())   numbers[i] = value.asInt32();
+		else
+		{
+			this->rejectedCount.fetch_add(1, std::memory_order_relaxed);
+
+			return;
+		}
+	}
+
+	Setpoint setpoint;
+	setpoint.time     = numbers[0];
+	setpoint.numPoses = (bottle.size() - 1)/6;
+
+	for(int i = 0; i < setpoint.numPoses; i++)
+	{
+		setpoint.pose[i] = transform_from_vector(std::vector<double>(numbers.begin() + 1 + 6*i, numbers.begin() + 7 + 6*i));
+	}
+
+	if(not this->queue.push(setpoint)) this->droppedCount.fetch_add(1, std::memory_order_relaxed); // Control thread isn't keeping up
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                Get the poses & twists for the given time from the setpoints either side         //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool SetpointStream::interpolate(const double              &time,
+                                 const unsigned int        &numPoses,
+                                 Eigen::Isometry3d         pose[],
+                                 Eigen::Matrix<double,6,1> twist[])
+{
+	// Move along the queue until the next setpoint is ahead of the given time
+	while(const Setpoint *sample = this->queue.front())
+	{
+		if(sample->numPoses != numPoses
+		or (this->hasNext and sample->time <= this->next.time))
+		{
+			this->rejectedCount.fetch_add(1, std::memory_order_relaxed);                // Wrong mode, or out of order
+		}
+		else if(not this->hasNext or this->next.time <= time)
+		{
+			this->previous    = this->next;
+			this->hasPrevious = this->hasNext;
+			this->next        = *sample;
+			this->hasNext     = true;
+		}
+		else break;                                                                         // Leave it for later
+
+		this->queue.pop();
+	}
+
+	if(not this->hasNext) return false;                                                         // Nothing received yet
+
+	if(this->next.time <= time)                                                                 // Stream stopped or is late, so hold the last pose
+	{
+		for(int i = 0; i < numPoses; i++)
+		{
+			pose[i] = this->next.pose[i];
+			twist[i].setZero();
+		}
+
+		this->held    = this->next;
+		this->holding = true;
+
+		return true;
+	}
+
+	// Resuming after a pause: go from the held pose starting now, not from when it was sent,
+	// otherwise most of the gap would be covered in one step
+	if(this->holding)
+	{
+		this->previous      = this->held;
+		this->previous.time = time;
+		this->hasPrevious   = true;
+		this->holding       = false;
+	}
+
+	if(not this->hasPrevious or time < this->previous.time) return false;                      // Not started yet
+
+	double duration = this->next.time - this->previous.time;
+	double fraction = (time - this->previous.time)/duration;
+
+	for(int i = 0; i < numPoses; i++)
+	{
+		const Eigen::Isometry3d &a = this->previous.pose[i];
+		const Eigen::Isometry3d &b = this->next.pose[i];
+
+		Eigen::Quaterniond qa(a.rotation()), qb(b.rotation());
+
+		pose[i] = Eigen::Translation3d((1 - fraction)*a.translation() + fraction*b.translation())
+		        * qa.slerp(fraction, qb);
+
+		Eigen::AngleAxisd rotation(b.rotation()*a.rotation().transpose());                  // From a to b, in the world frame
+
+		twist[i].head(3) = (b.translation() - a.translation())/duration;
+		twist[i].tail(3) = rotation.angle()*rotation.axis()/duration;
+	}
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                  Forget the previous stream, and any setpoints older than the given time       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void SetpointStream::discard_before(const double &time)
+{
+	this->hasPrevious = false;
+	this->hasNext     = false;
+	this->holding     = false;
+
+	while(const Setpoint *sample = this->queue.front())
+	{
+		if(sample->time >= time) break;
+
+		this->queue.pop();
+	}
+}
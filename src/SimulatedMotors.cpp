@@ -0,0 +1,215 @@
+#include <SimulatedMotors.h>
+
+static ScaledClock simulationClock;                                                                 // Outlives all the threads that use it
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                        Change the speed of the clock without a jump in time                    //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ScaledClock::set_scale(const double &_scale)
+{
+	this->simStart  = now();                                                                    // Continue on from the current time
+	this->realStart = yarp::os::SystemClock::nowSystem();
+	this->scale     = _scale;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                     Get the simulated time                                     //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+double ScaledClock::now()
+{
+	return this->simStart + this->scale*(yarp::os::SystemClock::nowSystem() - this->realStart);
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                              Wait for an amount of simulated time                              //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ScaledClock::delay(double seconds)
+{
+	yarp::os::SystemClock::delaySystem(seconds/this->scale);
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                      Set up the joints                                         //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool SimulatedMotors::open(const unsigned int &_numJoints, const SimulationParameters &parameters)
+{
+	std::string errorMessage = "[ERROR] [SIMULATED MOTORS] open(): ";
+
+	if(parameters.latency < 0 or parameters.noise < 0 or parameters.velocityLimit <= 0 or parameters.timeScale <= 0)
+	{
+		std::cerr << errorMessage << "Latency & noise must be non-negative, and the velocity limit "
+		          << "& time scale must be positive. Received a latency of " << parameters.latency
+		          << ", noise of " << parameters.noise << ", velocity limit of " << parameters.velocityLimit
+		          << ", and time scale of " << parameters.timeScale << ".\n";
+
+		return false;
+	}
+	else if(parameters.positionLimit.size() != 0 and parameters.positionLimit.size() != _numJoints)
+	{
+		std::cerr << errorMessage << "There are " << _numJoints << " joints but "
+		          << parameters.positionLimit.size() << " position limits.\n";
+
+		return false;
+	}
+	else if(parameters.initialPosition.size() != 0 and parameters.initialPosition.size() != _numJoints)
+	{
+		std::cerr << errorMessage << "There are " << _numJoints << " joints but the initial "
+		          << "position had " << parameters.initialPosition.size() << " elements.\n";
+
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	this->numJoints      = _numJoints;
+	this->latency        = parameters.latency;
+	this->noiseDeviation = parameters.noise;
+
+	if(parameters.positionLimit.size() == 0) this->positionLimit.assign(_numJoints, {-M_PI, M_PI});
+	else                                     this->positionLimit = parameters.positionLimit;
+
+	this->velocityLimit.assign(_numJoints, parameters.velocityLimit);
+
+	if(parameters.initialPosition.size() == 0) this->position = Eigen::VectorXd::Zero(_numJoints);
+	else                                       this->position = parameters.initialPosition;
+
+	for(int i = 0; i < this->numJoints; i++)
+	{
+		this->position(i) = std::max(this->positionLimit[i][0], std::min(this->position(i), this->positionLimit[i][1]));
+	}
+
+	this->velocity = Eigen::VectorXd::Zero(_numJoints);
+	this->target   = this->position;                                                           // Hold still until told otherwise
+	
+	this->inTransit.assign(maxInTransit, Command{0.0, Eigen::VectorXd::Zero(_numJoints)});    // Allocated here, not in write()
+	this->oldest       = 0;
+	this->numInTransit = 0;
+
+	if(parameters.timeScale != 1.0)
+	{
+		simulationClock.set_scale(parameters.timeScale);
+		yarp::os::Time::useCustomClock(&simulationClock);
+
+		std::cout << "[INFO] [SIMULATED MOTORS] Running at " << parameters.timeScale << " x real time.\n";
+	}
+
+	this->lastUpdate = yarp::os::Time::now();
+
+	this->isOpen = true;
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                  Get the (noisy) joint state                                   //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool SimulatedMotors::read(Eigen::VectorXd &pos, Eigen::VectorXd &vel, double &time)
+{
+	if(not this->isOpen) return false;
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	time = yarp::os::Time::now();
+
+	step(time);
+
+	for(int i = 0; i < this->numJoints; i++)
+	{
+		pos(i) = this->position(i) + this->noiseDeviation*this->noise(this->generator);
+		vel(i) = this->velocity(i);
+	}
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                        Send position commands, which arrive after the latency                  //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool SimulatedMotors::write(const Eigen::VectorXd &commands)
+{
+	if(not this->isOpen) return false;
+	else if(commands.size() != this->numJoints)
+	{
+		std::cerr << "[ERROR] [SIMULATED MOTORS] write(): "
+		          << "There are " << this->numJoints << " joints but the input argument had "
+		          << commands.size() << " elements.\n";
+
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	double time = yarp::os::Time::now();
+
+	step(time);                                                                                 // Catch up to now with the old set point
+
+	if(this->latency == 0) this->target = commands;
+	else
+	{
+		if(this->numInTransit == maxInTransit)                                              // Full, so the oldest arrives early
+		{
+			const Command &command = this->inTransit[this->oldest];
+			
+			this->target = command.position;
+			
+			this->oldest = (this->oldest + 1) % maxInTransit;
+			
+			this->numInTransit--;
+		}
+		
+		Command &command = this->inTransit[(this->oldest + this->numInTransit) % maxInTransit];
+		command.arrival  = time + this->latency;
+		command.position = commands;                                                        // Same size, so no allocation
+		
+		this->numInTransit++;
+	}
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                 Move forward in time, applying commands in the order they arrive               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void SimulatedMotors::step(const double &time)
+{
+	while(this->numInTransit > 0 and this->inTransit[this->oldest].arrival <= time)
+	{
+		const Command &command = this->inTransit[this->oldest];
+
+		integrate(command.arrival - this->lastUpdate);                                      // Move up until the command arrives
+
+		this->lastUpdate = command.arrival;
+
+		this->target = command.position;
+
+		this->oldest = (this->oldest + 1) % maxInTransit;
+
+		this->numInTransit--;
+	}
+
+	integrate(time - this->lastUpdate);
+
+	this->lastUpdate = time;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //           Move toward the set point as fast as the velocity & position limits allow           //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void SimulatedMotors::integrate(const double &duration)
+{
+	if(duration <= 0) return;
+
+	for(int i = 0; i < this->numJoints; i++)
+	{
+		double maxStep = this->velocityLimit[i]*duration;
+
+		double delta = std::max(-maxStep, std::min(this->target(i) - this->position(i), maxStep));
+
+		double newPosition = std::max(this->positionLimit[i][0],
+		                     std::min(this->position(i) + delta, this->positionLimit[i][1]));
+
+		this->velocity(i) = (newPosition - this->position(i))/duration;
+
+		this->position(i) = newPosition;
+	}
+}
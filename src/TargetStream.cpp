@@ -0,0 +1,118 @@
+#include <TargetStream.h>
+
+static const int32_t maxValues = 64;                                                                // More than any robot has joints
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                  Read a target from the connection                             //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool StreamedTarget::read(yarp::os::ConnectionReader &connection)
+{
+	if(connection.isTextMode()) return false;                                                   // Binary only
+
+	this->type     = connection.expectInt32();
+	this->sequence = connection.expectInt32();
+	this->time     = connection.expectFloat64();
+
+	int32_t count  = connection.expectInt32();
+
+	if(connection.isError() or count < 0 or count > maxValues) return false;
+
+	this->values.resize(count);                                                                 // Doesn't allocate once it has grown
+
+	for(int32_t i = 0; i < count; i++) this->values[i] = connection.expectFloat64();
+
+	return not connection.isError();
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                  Write a target to the connection                              //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool StreamedTarget::write(yarp::os::ConnectionWriter &connection) const
+{
+	connection.appendInt32(this->type);
+	connection.appendInt32(this->sequence);
+	connection.appendFloat64(this->time);
+	connection.appendInt32(this->values.size());
+
+	for(const double &value : this->values) connection.appendFloat64(value);
+
+	return not connection.isError();
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                  Open the port and start listening                             //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool TargetStream::open(const std::string &portName)
+{
+	if(not this->port.open(portName))
+	{
+		std::cerr << "[ERROR] [TARGET STREAM] open(): Could not open the port " << portName << ".\n";
+
+		return false;
+	}
+
+	this->port.setStrict(false);                                                                // Newest message replaces any still waiting
+
+	this->port.useCallback(*this);                                                              // onRead() runs on the port's own thread
+
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                Stop listening, and report the counts                           //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void TargetStream::close()
+{
+	this->port.disableCallback();
+
+	this->port.close();
+
+	std::cout << "[INFO] [TARGET STREAM] Received " << received() << " targets. "
+	          << dropped() << " were replaced by newer ones before they were read, and "
+	          << rejected() << " were rejected.\n";
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                   Send the newest target to the robot                          //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void TargetStream::onRead(StreamedTarget &target)
+{
+	this->receivedCount.fetch_add(1, std::memory_order_relaxed);
+
+	// Any gap in the sequence was overwritten on the port. Going backwards means the sender restarted
+	if(this->hasSequence and target.sequence > this->lastSequence + 1)
+	{
+		this->droppedCount.fetch_add(target.sequence - this->lastSequence - 1, std::memory_order_relaxed);
+	}
+
+	this->hasSequence  = true;
+	this->lastSequence = target.sequence;
+
+	bool accepted = false;
+
+	// Joint & hand targets would drop the object, so they are refused while grasping, as over RPC
+	bool grasping = this->robot->is_grasping();
+
+	if(target.time > 0.0)
+	{
+		if(target.type == StreamedTarget::joints and not grasping)
+		{
+			accepted = this->robot->move_to_position(Eigen::Map<const Eigen::VectorXd>(target.values.data(),
+			                                                                           target.values.size()),
+			                                         target.time);
+		}
+		else if(target.type == StreamedTarget::hands and target.values.size() == 12 and not grasping)
+		{
+			std::vector<double> left(target.values.begin(), target.values.begin() + 6);
+			std::vector<double> right(target.values.begin() + 6, target.values.end());
+
+			accepted = this->robot->move_to_pose(transform_from_vector(left), transform_from_vector(right), target.time);
+		}
+		else if(target.type == StreamedTarget::object and target.values.size() == 6)
+		{
+			accepted = this->robot->move_object(transform_from_vector(target.values), target.time);
+		}
+	}
+
+	if(not accepted) this->rejectedCount.fetch_add(1, std::memory_order_relaxed);
+}
@@ -239,3 +239,55 @@ bool load_cartesian_trajectories(const yarp::os::Bottle *bottle,
 	
 	return true;
 }
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                    Get the parameters for the simulated motors from the config file            //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool load_simulation_parameters(const yarp::os::Bottle *bottle, SimulationParameters &parameters)
+{
+	if(bottle == nullptr or bottle->isNull())
+	{
+		std::cerr << "[ERROR] load_simulation_parameters(): Could not find the SIMULATION group in the config file.\n";
+		
+		return false;
+	}
+	
+	// Anything not listed keeps its default value
+	parameters.latency       = bottle->check("latency",        yarp::os::Value(parameters.latency)).asFloat64();
+	parameters.noise         = bottle->check("noise",          yarp::os::Value(parameters.noise)).asFloat64();
+	parameters.timeScale     = bottle->check("time_scale",     yarp::os::Value(parameters.timeScale)).asFloat64();
+	parameters.velocityLimit = bottle->check("velocity_limit", yarp::os::Value(parameters.velocityLimit)).asFloat64();
+	
+	yarp::os::Bottle *lower = bottle->find("lower_limits").asList();
+	yarp::os::Bottle *upper = bottle->find("upper_limits").asList();
+	
+	if(lower != nullptr and upper != nullptr)
+	{
+		Eigen::VectorXd lowerLimit = vector_from_bottle(lower);
+		Eigen::VectorXd upperLimit = vector_from_bottle(upper);
+		
+		if(lowerLimit.size() != upperLimit.size())
+		{
+			std::cerr << "[ERROR] load_simulation_parameters(): There were " << lowerLimit.size()
+			          << " lower limits but " << upperLimit.size() << " upper limits.\n";
+			
+			return false;
+		}
+		
+		parameters.positionLimit.resize(lowerLimit.size());
+		
+		for(int i = 0; i < lowerLimit.size(); i++) parameters.positionLimit[i] = {lowerLimit(i), upperLimit(i)};
+	}
+	else if(lower != nullptr or upper != nullptr)
+	{
+		std::cerr << "[ERROR] load_simulation_parameters(): Both 'lower_limits' and 'upper_limits' must be listed.\n";
+		
+		return false;
+	}
+	
+	yarp::os::Bottle *initial = bottle->find("initial_position").asList();
+	
+	if(initial != nullptr) parameters.initialPosition = vector_from_bottle(initial);
+	
+	return true;
+}
@@ -6,106 +6,102 @@
 iCubBase::iCubBase(const std::string &pathToURDF,
                    const std::vector<std::string> &jointList,
                    const std::vector<std::string> &portList,
-                   const std::string              &robotModel)
+                   const std::string              &robotModel,
+                   const JointInterface::Backend  &backend,
+                   const SimulationParameters     &simulation)
                    :
-                   yarp::os::PeriodicThread(0.01),                                                  // Create thread to run at 100Hz
-                   JointInterface(jointList, portList),                                             // Open communication with joint motors
+                   iCubBase(std::async(std::launch::async, [pathToURDF, jointList, robotModel]()
+                            {
+                                    LoadedModel loaded;
+                                    loaded.first = load_robot_model(pathToURDF, jointList, robotModel, loaded.second);
+                                    return loaded;
+                            }),                                                                     // Parse the URDF on another thread...
+                            std::chrono::steady_clock::now(),
+                            pathToURDF, jointList, portList, robotModel, backend, simulation) {}    // ... while the drivers are opened
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                    Constructor, once the model has started loading                             //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+iCubBase::iCubBase(std::future<LoadedModel>                    model,
+                   const std::chrono::steady_clock::time_point &start,
+                   const std::string                           &pathToURDF,
+                   const std::vector<std::string>              &jointList,
+                   const std::vector<std::string>              &portList,
+                   const std::string                           &robotModel,
+                   const JointInterface::Backend               &backend,
+                   const SimulationParameters                  &simulation)
+                   :
+                   yarp::os::PeriodicThread(defaultPeriod),                                         // Create thread to run at 100Hz
+                   JointInterface(jointList, portList, backend, simulation),                        // Open communication with joint motors
                    _robotModel(robotModel),                                                         // iCub2, iCub3, ergoCub
                    q(Eigen::VectorXd::Zero(this->numJoints)),                                       // Set the size of the position vector
                    qdot(Eigen::VectorXd::Zero(this->numJoints)),                                    // Set the size of the velocity vector
                    J(Eigen::MatrixXd::Zero(12,this->numJoints)),                                    // Set the size of the Jacobian matrix
                    M(Eigen::MatrixXd::Zero(this->numJoints,this->numJoints)),                       // Set the size of the inertia matrix
                    invM(Eigen::MatrixXd::Zero(this->numJoints,this->numJoints)),                    // Set the size of the inverse inertia
-                   desiredPosition(Eigen::VectorXd::Zero(this->numJoints))                          // Desired configuration when running Cartesian control
+                   desiredPosition(Eigen::VectorXd::Zero(this->numJoints)),                         // Desired configuration when running Cartesian control
+                   gravity(std::vector<double> {0.0, 0.0, -9.81}),                                  // Direction of gravity
+                   jacobianBuffer(Eigen::MatrixXd::Zero(6,6+this->numJoints)),                      // Hand Jacobian with the floating base
+                   massBuffer(Eigen::MatrixXd::Zero(6+this->numJoints,6+this->numJoints)),          // Inertia with the floating base
+                   massDecomposition(this->numJoints),                                              // Allocate the LU decomposition
+                   jointPositionBuffer(this->numJoints),                                            // Joint positions for iDynTree
+                   jointVelocityBuffer(this->numJoints)                                             // Joint velocities for iDynTree
 {
-	iDynTree::ModelLoader loader;
-	
 	std::string message = "[ERROR] [ICUB BASE] Constructor: ";
 	
-	if(not loader.loadReducedModelFromFile(pathToURDF, jointList, "urdf"))
+	auto driversReady = std::chrono::steady_clock::now();
+	
+	LoadedModel loaded = model.get();                                                           // Rethrows if it failed
+	
+	this->basePose = loaded.second;
+	
+	// Now load the model in to the KinDynComputations class	    
+	if(not this->computer.loadRobotModel(loaded.first))
 	{
-		message += "Could not load model from the path " + pathToURDF + ".";
+		message += "Could not generate iDynTree::KinDynComputations object from the model "
+		              + loaded.first.toString() + ".";
+
 		throw std::runtime_error(message);
 	}
 	else
 	{
-		iDynTree::Model temp = loader.model();
+		// Size the buffers shared with the control thread so it never has to
+		ControlPlan initialPlan;
+		this->plans.fill(initialPlan);
 		
-		// Add custom hand frames and base/torso pose based on the model
-		if(this->_robotModel == "iCub2")
-		{
-			temp.addAdditionalFrameToLink("l_hand", "left",
-			                              iDynTree::Transform(iDynTree::Rotation::RPY(0.0,0.0,0.0),
-			                                                  iDynTree::Position(0.05765, -0.00556, 0.01369)));
+		PlanningState initialState;
+		initialState.q    = Eigen::VectorXd::Zero(this->numJoints);
+		initialState.qdot = Eigen::VectorXd::Zero(this->numJoints);
+		this->states.fill(initialState);
+					
+		// Set the static parts of the grasp matrices
 		
-			temp.addAdditionalFrameToLink("r_hand", "right",
-						      iDynTree::Transform(iDynTree::Rotation::RPY(0.0,0.0,M_PI),
-						                          iDynTree::Position(-0.05765, -0.00556, 0.01369)));
-
-			this->basePose = iDynTree::Transform(iDynTree::Rotation::RPY(0,0,-M_PI),
-			                                     iDynTree::Position(0,0,0));
-		}
-		else if(this->_robotModel == "iCub3")
-		{
-			throw std::runtime_error(message + "Hand transforms for iCub3 have not been programmed yet!");
-		}
-		else if(this->_robotModel == "ergoCub")
-		{
-			temp.addAdditionalFrameToLink("l_hand_palm", "left",
-			                              iDynTree::Transform(iDynTree::Rotation::RPY(0.0,M_PI/2,0.0),
-			                                                  iDynTree::Position(-0.00346, 0.00266, -0.0592)));
-                	temp.addAdditionalFrameToLink("r_hand_palm", "right",
-                				      iDynTree::Transform(iDynTree::Rotation::RPY(0.0,M_PI/2,0.0),
-                				                          iDynTree::Position(-0.00387, -0.00280, -0.0597)));
-			
-			this->basePose = iDynTree::Transform(iDynTree::Rotation::RPY(0,0,0),
-			                                     iDynTree::Position(0,0,0));
-		}
-		else
-		{	
-			message += "Expected 'iCub2', 'iCub3' or 'ergoCub' for the robot model argument, "
-			                "but your input was '" + robotModel + "'.";
-			                            
-			throw std::invalid_argument(message);
-		}
+		// G = [    I    0     I    0 ]
+		//     [ S(left) I S(right) I ]
+		this->G.block(0,0,3,3).setIdentity();
+		this->G.block(0,3,3,3).setZero();
+		this->G.block(0,6,3,3).setIdentity();
+		this->G.block(0,9,3,3).setZero();
+		this->G.block(3,3,3,3).setIdentity();
+		this->G.block(3,9,3,3).setIdentity();
 		
-		// Now load the model in to the KinDynComputations class	    
-		if(not this->computer.loadRobotModel(temp))
-		{
-			message += "Could not generate iDynTree::KinDynComputations object from the model "
-			              + loader.model().toString() + ".";
-
-			throw std::runtime_error(message);
-		}
-		else
-		{
-			// Resize vectors and matrices based on number of joints
-			this->jointTrajectory.resize(this->numJoints);                              // Trajectory for joint motion control		
-						
-			// Set the static parts of the grasp matrices
-			
-			// G = [    I    0     I    0 ]
-			//     [ S(left) I S(right) I ]
-			this->G.block(0,0,3,3).setIdentity();
-			this->G.block(0,3,3,3).setZero();
-			this->G.block(0,6,3,3).setIdentity();
-			this->G.block(0,9,3,3).setZero();
-			this->G.block(3,3,3,3).setIdentity();
-			this->G.block(3,9,3,3).setIdentity();
-			
-			// C = [  I  -S(left) -I  S(right) ]
-			//     [  0      I     0     -I    ]
-			C.block(0,0,3,3).setIdentity();
-			C.block(0,6,3,3) = -C.block(0,0,3,3);
-			C.block(3,0,3,3).setZero();
-			C.block(3,3,3,3).setIdentity();
-			C.block(3,6,3,3).setZero();
-			C.block(3,9,3,3) = -C.block(0,0,3,3);
-			
-			if(not update_state()) throw std::runtime_error(message + "Unable to read initial joint state from the encoders.");
-			
-			std::cout << "[INFO] [ICUB BASE] Successfully created iDynTree model from " << pathToURDF << ".\n";
-		}
+		// C = [  I  -S(left) -I  S(right) ]
+		//     [  0      I     0     -I    ]
+		C.block(0,0,3,3).setIdentity();
+		C.block(0,6,3,3) = -C.block(0,0,3,3);
+		C.block(3,0,3,3).setZero();
+		C.block(3,3,3,3).setIdentity();
+		C.block(3,6,3,3).setZero();
+		C.block(3,9,3,3) = -C.block(0,0,3,3);
+		
+		if(not update_state()) throw std::runtime_error(message + "Unable to read initial joint state from the encoders.");
+		
+		auto finished = std::chrono::steady_clock::now();
+		
+		std::cout << "[INFO] [ICUB BASE] Successfully created iDynTree model from " << pathToURDF << ". "
+		          << "Started up in " << std::chrono::duration<double>(finished - start).count() << " s, "
+		          << "of which " << std::chrono::duration<double>(finished - driversReady).count()
+		          << " s was after the joint motors were ready.\n";
 	}
 }
 
@@ -115,38 +111,44 @@ iCubBase::iCubBase(const std::string &pathToURDF,
 bool iCubBase::update_state()
 {
 	if(JointInterface::read_encoders(this->q, this->qdot))
-	{		
+	{
+		// The encoders were sampled a little while ago, and the next command won't land until a
+		// little while later, so extrapolate the joint state to when the command takes effect
+		double now = yarp::os::Time::now();
+		
+		double horizon = std::min(JointInterface::sensing_delay(now) + this->actuationLatency, this->maxPrediction);
+		
+		this->q += horizon*this->qdot;
+		
+		this->stateTime = now + this->actuationLatency;                                     // Trajectories are evaluated at this time
+		
 		// Put data in iDynTree class to compute inverse dynamics
 		// (there is probably a smarter way but I keep getting errors otherwise)
-		iDynTree::VectorDynSize tempPosition(this->numJoints);
-		iDynTree::VectorDynSize tempVelocity(this->numJoints);
 		for(int i = 0; i < this->numJoints; i++)
 		{
-			tempPosition(i) = this->q(i);
-			tempVelocity(i) = this->qdot(i);
+			this->jointPositionBuffer(i) = this->q(i);
+			this->jointVelocityBuffer(i) = this->qdot(i);
 		}
 
 		// Put them in to the iDynTree class to solve the kinematics and dynamics
 		if(this->computer.setRobotState(this->basePose,
-		                                tempPosition,
+		                                this->jointPositionBuffer,
 		                                iDynTree::Twist(iDynTree::GeomVector3(0,0,0), iDynTree::GeomVector3(0,0,0)), // Torso twist
-		                                tempVelocity,                                       // Joint velocities
-		                                iDynTree::Vector3(std::vector<double> {0.0, 0.0, -9.81}))) // Direction of gravity
+		                                this->jointVelocityBuffer,                          // Joint velocities
+		                                this->gravity))                                     // Direction of gravity
 		{
 			// Get the Jacobian for the hands
-			Eigen::MatrixXd temp(6,6+this->numJoints);                                  // Temporary storage
-			
-			this->computer.getFrameFreeFloatingJacobian("left",temp);                   // Compute left hand Jacobian
-			this->J.block(0,0,6,this->numJoints) = temp.block(0,6,6,this->numJoints);   // Assign to larger matrix
+			this->computer.getFrameFreeFloatingJacobian("left",this->jacobianBuffer);   // Compute left hand Jacobian
+			this->J.block(0,0,6,this->numJoints) = this->jacobianBuffer.block(0,6,6,this->numJoints); // Assign to larger matrix
 			
-			this->computer.getFrameFreeFloatingJacobian("right",temp);                  // Compute right hand Jacobian
-			this->J.block(6,0,6,this->numJoints) = temp.block(0,6,6,this->numJoints);   // Assign to larger matrix
+			this->computer.getFrameFreeFloatingJacobian("right",this->jacobianBuffer);  // Compute right hand Jacobian
+			this->J.block(6,0,6,this->numJoints) = this->jacobianBuffer.block(0,6,6,this->numJoints); // Assign to larger matrix
 			
 			// Compute inertia matrix
-			temp.resize(6+this->numJoints,6+this->numJoints);
-			this->computer.getFreeFloatingMassMatrix(temp);                             // Compute inertia matrix for joints & base
-			this->M = temp.block(6,6,this->numJoints,this->numJoints);                  // Remove floating base
-			this->invM = this->M.partialPivLu().inverse();                              // We will need the inverse late
+			this->computer.getFreeFloatingMassMatrix(this->massBuffer);                 // Compute inertia matrix for joints & base
+			this->M = this->massBuffer.block(6,6,this->numJoints,this->numJoints);      // Remove floating base
+			this->massDecomposition.compute(this->M);
+			this->invM = this->massDecomposition.inverse();                             // We will need the inverse later
 			
 			// Update hand poses
 			this->leftPose  = iDynTree_to_Eigen(this->computer.getWorldTransform("left"));
@@ -188,6 +190,17 @@ bool iCubBase::update_state()
 				this->C.block(0,9,3,3) =-S;
 			}
 			
+			// Share the state so new plans start from where the robot is
+			PlanningState &snapshot = this->states.write_buffer();
+			snapshot.q          = this->q;
+			snapshot.qdot       = this->qdot;
+			snapshot.leftPose   = this->leftPose;
+			snapshot.rightPose  = this->rightPose;
+			snapshot.leftTwist  = iDynTree::toEigen(this->computer.getFrameVel("left"));
+			snapshot.rightTwist = iDynTree::toEigen(this->computer.getFrameVel("right"));
+			snapshot.payload    = this->payload;
+			this->states.publish();
+			
 			return true;
 		}
 		else
@@ -236,11 +249,7 @@ Eigen::Isometry3d iCubBase::iDynTree_to_Eigen(const iDynTree::Transform &T)
 bool iCubBase::move_to_position(const Eigen::VectorXd &position,
                                 const double &time)
 {
-	if((this->q - position).norm() < 0.5 and this->qdot.norm() < 0.5)
-	{
-		return true;            // Already there
-	}
-	else if(position.size() != this->numJoints)
+	if(position.size() != this->numJoints)
 	{
 		std::cerr << "[ERROR] [ICUB BASE] move_to_position(): "
 			  << "Position vector had " << position.size() << " elements, "
@@ -248,6 +257,13 @@ bool iCubBase::move_to_position(const Eigen::VectorXd &position,
 			  
 		return false;
 	}
+	
+	PlanningState state = latest_state();
+	
+	if((state.q - position).norm() < 0.5 and state.qdot.norm() < 0.5)
+	{
+		return true;            // Already there
+	}
 	else
 	{
 		std::vector<Eigen::VectorXd> target; target.push_back(position);                    // Insert in to std::vector to pass onward
@@ -261,8 +277,10 @@ bool iCubBase::move_to_position(const Eigen::VectorXd &position,
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 void iCubBase::halt()
 {
+	std::lock_guard<std::mutex> lock(this->planMutex);                                          // Plans may be published from another thread
+	
 	if(isRunning()) stop();                                                                     // Stop any control threads that are running
-	this->isFinished = true;
+	this->finishedPlan = this->plannedId.load();                                                // Nothing left to do
 	send_joint_commands(this->q);                                                               // Hold current joint positions
 }
 
@@ -271,60 +289,135 @@ void iCubBase::halt()
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 bool iCubBase::move_to_positions(const std::vector<Eigen::VectorXd> &positions,
                                  const std::vector<double> &times)
+{
+	MultiSpline compiled;
+	
+	if(not compile_joint_motion(positions, times, compiled)) return false;
+	
+	return move_to_positions(compiled);
+}
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////////
+ //          Solve a joint trajectory now, so it can be started from anywhere later               //
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::compile_joint_motion(const std::vector<Eigen::VectorXd> &positions,
+                                    const std::vector<double> &times,
+                                    MultiSpline &compiled)
 {
 	if(positions.size() != times.size())
 	{
-		std::cout << "[ERROR] [ICUB BASE] move_to_positions(): "
+		std::cout << "[ERROR] [ICUB BASE] compile_joint_motion(): "
 		          << "Position array had " << positions.size() << " waypoints, "
 		          << "but the time array had " << times.size() << " elements!" << std::endl;
 
 		return false;
 	}
-	else
+	
+	int m = positions.size() + 1;                                                               // We need to add 1 extra waypoint for the start
+	Eigen::MatrixXd waypoints = Eigen::MatrixXd::Zero(this->numJoints, m);                      // Column j is the jth waypoint for all joints
+	std::vector<double> t(m);                                                                   // Times to reach the waypoints
+	
+	t[0] = 0.0;                                                                                 // Start immediately, from wherever the joints are then
+	
+	for(int j = 1; j < m; j++)                                                                  // For the jth waypoint...
 	{
-		if(isRunning()) stop();                                                             // Stop any control thread that might be running
-		this->controlSpace = joint;                                                         // Switch to joint control mode
-		int m = positions.size() + 1;                                                       // We need to add 1 extra waypoint for the start
-		iDynTree::VectorDynSize waypoint(m);                                                // All the waypoints for a single joint
-		iDynTree::VectorDynSize t(m);                                                       // Times to reach the waypoints
+		if(positions[j-1].size() != this->numJoints)
+		{
+			std::cerr << "[ERROR] [ICUB BASE] compile_joint_motion(): "
+			          << "There are " << this->numJoints << " joints, but waypoint " << j-1
+			          << " had " << positions[j-1].size() << " elements.\n";
+			
+			return false;
+		}
 		
-		for(int i = 0; i < this->numJoints; i++)                                            // For the ith joint...
+		for(int i = 0; i < this->numJoints; i++)                                            // ... and ith joint
 		{
-			for(int j = 0; j < m; j++)                                                  // ... and jth waypoint
-			{
-				if(j == 0)
-				{
-					waypoint[j] = this->q[i];                                   // Current position is start point
-					t[j] = 0.0;                                                 // Start immediately
-				}
-				else
-				{
-					double target = positions[j-1][i];                          // Get the jth target for the ith joint
-					
-					     if(target < this->positionLimit[i][0]) target = this->positionLimit[i][0] + 0.001;
-					else if(target > this->positionLimit[i][1]) target = this->positionLimit[i][1] - 0.001;
-					
-					waypoint[j] = target;                                       // Assign the target for the jth waypoint
-					
-					t[j] = times[j-1];                                          // Add on subsequent time data
-				}
-			}
+			double target = positions[j-1][i];                                          // Get the jth target for the ith joint
 			
-			if(not this->jointTrajectory[i].setData(t,waypoint))
-			{
-				std::cerr << "[ERROR] [ICUB BASE] move_to_positions(): "
-				          << "There was a problem setting new joint trajectory data." << std::endl;
+			     if(target < this->positionLimit[i][0]) target = this->positionLimit[i][0] + 0.001;
+			else if(target > this->positionLimit[i][1]) target = this->positionLimit[i][1] - 0.001;
 			
-				return false;
-			}
-			else this->jointTrajectory[i].setInitialConditions(this->qdot[i],0.0);      // Use the current joint velocity
+			waypoints(i,j) = target;                                                    // Assign the target for the jth waypoint
 		}
 		
-		this->endTime = times.back();                                                       // Assign the end time
+		t[j] = times[j-1];                                                                  // Add on subsequent time data
+	}
+	
+	try
+	{
+		compiled = MultiSpline(waypoints, t);                                               // All joints at once
+		
+		return true;
+	}
+	catch(std::exception &exception)
+	{
+		std::cerr << "[ERROR] [ICUB BASE] compile_joint_motion(): "
+		          << "There was a problem setting new joint trajectory data.\n";
+		
+		std::cout << exception.what() << std::endl;
+		
+		return false;
+	}
+}
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////////
+ //               Start a compiled joint trajectory from the current joint state                  //
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::move_to_positions(const MultiSpline &compiled)
+{
+	if(compiled.dimensions() != this->numJoints)
+	{
+		std::cerr << "[ERROR] [ICUB BASE] move_to_positions(): "
+		          << "There are " << this->numJoints << " joints, but the trajectory had "
+		          << compiled.dimensions() << " dimensions.\n";
+		
+		return false;
+	}
+	
+	PlanningState state = latest_state();                                                       // Start from here
+	
+	ControlPlan newPlan;
+	newPlan.controlSpace = joint;                                                               // Switch to joint control mode
+	
+	if(this->retimeTrajectories)                                                                // Replace the given times with the quickest possible
+	{
+		Eigen::MatrixXd waypoints = compiled.waypoints();
+		waypoints.col(0) = state.q;
+		
+		double scale = this->retimingScale;                                                 // Read once, in case it is being reloaded
+		
+		Eigen::VectorXd maxVelocity(this->numJoints);
+		for(int i = 0; i < this->numJoints; i++) maxVelocity(i) = scale*this->velocityLimit[i];
+		
+		Eigen::VectorXd maxAcceleration = Eigen::VectorXd::Constant(this->numJoints, scale*this->maxAcc);
+		
+		try
+		{
+			std::vector<double> t = MultiSpline::fastest_times(waypoints, state.qdot, maxVelocity, maxAcceleration);
+			
+			newPlan.jointTrajectory = MultiSpline(waypoints, t, state.qdot);
+		}
+		catch(std::exception &exception)
+		{
+			std::cerr << "[ERROR] [ICUB BASE] move_to_positions(): "
+			          << "Could not retime the joint trajectory.\n";
+			
+			std::cout << exception.what() << std::endl;
+			
+			return false;
+		}
+	}
+	else
+	{
+		newPlan.jointTrajectory = compiled;                                                 // Shares the coefficients
 		
-		start();                                                                            // Start the control thread
-		return true;                                                                        // Success
+		newPlan.jointTrajectory.set_start(state.q, state.qdot);                             // Start at the current joint velocity
 	}
+	
+	newPlan.startTime = plan_time();                                                            // Trajectory starts from here
+	newPlan.endTime   = newPlan.jointTrajectory.end_time();                                     // Assign the end time
+	
+	return publish_plan(newPlan);                                                               // Takes effect on the next control step                                                                                // Success
 }
 
   ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -334,12 +427,23 @@ bool iCubBase::move_to_pose(const Eigen::Isometry3d &desiredLeft,
                             const Eigen::Isometry3d &desiredRight,
                             const double &time)
 {
-	if( (pose_error(desiredLeft,this->leftPose)).norm() < 0.01
-	and (pose_error(desiredRight,this->rightPose)).norm() < 0.01) return true;                  // Already there	
+	PlanningState state = latest_state();
+	
+	if( (pose_error(desiredLeft,state.leftPose)).norm() < 0.01
+	and (pose_error(desiredRight,state.rightPose)).norm() < 0.01) return true;                  // Already there	
 	
 	// Put them in to std::vector objects and pass onward
 	std::vector<Eigen::Isometry3d> leftPoses(1,desiredLeft);
 	std::vector<Eigen::Isometry3d> rightPoses(1,desiredRight);
+	
+	// Move the targets somewhere reachable, or give up
+	Eigen::Vector3d shift;
+	
+	if(not check_reach(ReachabilityMap::left, desiredLeft.translation(), shift)) return false;
+	leftPoses[0].translation() += shift;
+	
+	if(not check_reach(ReachabilityMap::right, desiredRight.translation(), shift)) return false;
+	rightPoses[0].translation() += shift;
 	std::vector<double> times(1,time);
 	
 	return move_to_poses(leftPoses,rightPoses,times);                                           // Call full function
@@ -352,35 +456,61 @@ bool iCubBase::move_to_poses(const std::vector<Eigen::Isometry3d> &left,
                              const std::vector<Eigen::Isometry3d> &right,
                              const std::vector<double> &times)
 {
-	if(isRunning()) stop();                                                                     // Stop any control threads that are running
-	this->controlSpace = cartesian;                                                             // Switch to Cartesian control mode
+	try
+	{
+		return move_to_poses(CartesianTrajectory::compile(left, times),
+		                     CartesianTrajectory::compile(right, times));
+	}
+	catch(std::exception &exception)
+	{
+		std::cerr << "[ERROR] [ICUB BASE] move_to_poses(): "
+		          << "Unable to set new Cartesian trajectories.\n";
+		
+		std::cout << exception.what() << std::endl;
+
+		return false;
+	}
+}
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////////
+ //                  Start compiled trajectories for both hands from where they are               //
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::move_to_poses(const MultiSpline &left, const MultiSpline &right)
+{
+	PlanningState state = latest_state();                                                       // Start from here
 	
-	// Set up the times for the trajectory
-	std::vector<double> t; t.push_back(0.0);                                                    // Start immediately
-	t.insert(t.end(),times.begin(),times.end());                                                // Add on the rest of the times
+	ControlPlan newPlan;
+	newPlan.controlSpace = cartesian;                                                           // Switch to Cartesian control mode
+	newPlan.isGrasping   = false;                                                               // Hands move independently
+	newPlan.startTime    = plan_time();                                                         // On the control loop's clock
 	
-	// Set up the waypoints for each hand
-	std::vector<Eigen::Isometry3d> leftPoints; leftPoints.push_back(this->leftPose);            // First waypoint is current pose
-	leftPoints.insert(leftPoints.end(),left.begin(),left.end());
+	// Start from the measured state, unless there is a running trajectory to carry on from
+	Eigen::Isometry3d leftStart  = state.leftPose;
+	Eigen::Isometry3d rightStart = state.rightPose;
+	Eigen::Matrix<double,6,1> leftVel  = state.leftTwist,  leftAcc  = Eigen::Matrix<double,6,1>::Zero();
+	Eigen::Matrix<double,6,1> rightVel = state.rightTwist, rightAcc = Eigen::Matrix<double,6,1>::Zero();
 	
-	std::vector<Eigen::Isometry3d> rightPoints; rightPoints.push_back(this->rightPose);
-	rightPoints.insert(rightPoints.end(), right.begin(), right.end());
+	{
+		std::lock_guard<std::mutex> lock(this->planMutex);
+		
+		if(can_blend(false, newPlan.startTime))
+		{
+			double elapsed = newPlan.startTime - this->lastPlan.startTime;              // Time along the old trajectory
+			
+			this->lastPlan.leftTrajectory.get_state(leftStart, leftVel, leftAcc, elapsed);
+			this->lastPlan.rightTrajectory.get_state(rightStart, rightVel, rightAcc, elapsed);
+		}
+	}
 	
 	try
 	{
-		Eigen::Matrix<double,6,1> twist = iDynTree::toEigen(this->computer.getFrameVel("left"));
+		newPlan.leftTrajectory  = CartesianTrajectory(left, leftStart, leftVel, leftAcc);   // Assign new trajectory for left hand
 		
-		this->leftTrajectory  = CartesianTrajectory(leftPoints,t,twist);                    // Assign new trajectory for left hand
+		newPlan.rightTrajectory = CartesianTrajectory(right, rightStart, rightVel, rightAcc); // Assign new trajectory for right hand
 		
-		twist = iDynTree::toEigen(this->computer.getFrameVel("right"));
+		newPlan.endTime = std::max(left.end_time(), right.end_time());                      // For checking when done
 		
-		this->rightTrajectory = CartesianTrajectory(rightPoints,t, twist);                  // Assign new trajectory for right hand
-		
-		this->endTime = times.back();                                                       // For checking when done
-		
-		start();                                                                            // Go to threadInit();
-		
-		return true;
+		return publish_plan(newPlan);                                                       // Takes effect on the next control step
 	}
 	catch(std::exception &exception)
 	{
@@ -393,12 +523,83 @@ bool iCubBase::move_to_poses(const std::vector<Eigen::Isometry3d> &left,
 	}
 }
 
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                          Open the port that external setpoints arrive on                       //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::open_setpoint_stream(const std::string &portName, const double &delay)
+{
+	if(delay < 0)
+	{
+		std::cerr << "[ERROR] [ICUB BASE] open_setpoint_stream(): "
+		          << "Delay of " << delay << " cannot be negative.\n";
+		
+		return false;
+	}
+	
+	this->streamDelay = delay;
+	
+	this->streamOpen = this->setpoints.open(portName);
+	
+	return this->streamOpen;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //           Follow the hand (or object) poses arriving on the setpoint port until told otherwise   //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::start_streaming()
+{
+	if(not this->streamOpen)
+	{
+		std::cerr << "[ERROR] [ICUB BASE] start_streaming(): "
+		          << "The setpoint port has not been opened.\n";
+		
+		return false;
+	}
+	
+	PlanningState state = latest_state();
+	
+	ControlPlan newPlan;
+	newPlan.controlSpace = streaming;
+	newPlan.isGrasping   = this->graspPlanned;                                                  // Stream the object pose if holding something
+	newPlan.payload      = state.payload;
+	newPlan.graspWidth   = this->plannedGraspWidth;
+	newPlan.startTime    = plan_time();                                                         // On the control loop's clock
+	newPlan.endTime      = std::numeric_limits<double>::infinity();                             // Until another command replaces it
+	
+	try
+	{
+		// Hold still until the first setpoints arrive
+		std::vector<double> t = {0.0, 1.0};
+		
+		if(newPlan.isGrasping)
+		{
+			newPlan.payloadTrajectory = CartesianTrajectory(std::vector<Eigen::Isometry3d>(2,state.payload.pose()),t);
+		}
+		else
+		{
+			newPlan.leftTrajectory  = CartesianTrajectory(std::vector<Eigen::Isometry3d>(2,state.leftPose),t);
+			newPlan.rightTrajectory = CartesianTrajectory(std::vector<Eigen::Isometry3d>(2,state.rightPose),t);
+		}
+	}
+	catch(std::exception &exception)
+	{
+		std::cerr << "[ERROR] [ICUB BASE] start_streaming(): "
+		          << "Could not set the initial trajectories.\n";
+		
+		std::cout << exception.what() << std::endl;
+		
+		return false;
+	}
+	
+	return publish_plan(newPlan);                                                               // Takes effect on the next control step
+}
+
   ////////////////////////////////////////////////////////////////////////////////////////////////////
  //                               Grasp an object with two hands                                   //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 bool iCubBase::grasp_object()
 {
-	if(this->isGrasping)
+	if(this->graspPlanned)
 	{
 		std::cout << "[ERROR] [ICUB BASE] grasp_object(): "
 		          << "Already grasping an object! "
@@ -407,22 +608,18 @@ bool iCubBase::grasp_object()
 		return false;
 	}
 	else
-	{		
-		this->isGrasping = true;                                                            // Set grasp constraint
+	{
+		PlanningState state = latest_state();
 		
-		this->graspWidth = (this->leftPose.translation() - this->rightPose.translation()).norm(); // Distance between the hands
+		double width = (state.leftPose.translation() - state.rightPose.translation()).norm(); // Distance between the hands
 		
-		Eigen::Isometry3d localPose(Eigen::Translation3d(0,-graspWidth/2,0));               // Negative y-axis of left hand, half the distance between hands
+		Eigen::Isometry3d localPose(Eigen::Translation3d(0,-width/2,0));                    // Negative y-axis of left hand, half the distance between hands
 		
-		this->payload = Payload(localPose);                                                 // Set the payload
+		Payload object(localPose);                                                          // Set the payload
 		
-		if(update_state()) return move_object(this->payload.pose(), 1.0);                   // Update pose, grasp constraints, activate control
-		else
-		{
-			std::cout << "[ERROR] [ICUB BASE] grasp_object(): Something went wrong.\n";
-			          
-			return false;
-		}
+		object.update_state(state.leftPose, state.leftTwist);                               // Get the current pose of the object
+		
+		return plan_object_motion(object, width, std::vector<Eigen::Isometry3d>(1,object.pose()), std::vector<double>(1,1.0)); // Hold it where it is
 	}
 }
   
@@ -431,13 +628,14 @@ bool iCubBase::grasp_object()
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 bool iCubBase::release_object()
 {
-	if(this->isGrasping)
+	if(this->graspPlanned)
 	{
-		this->isGrasping = false;                                                          // Deactivate grasp constraints
-		
-		move_to_pose(this->leftPose,this->rightPose,1.0);                                  // Maintain current hand poses		
+		PlanningState state = latest_state();
 		
-		return true;
+		// Maintain current hand poses, without the grasp constraints
+		return move_to_poses(std::vector<Eigen::Isometry3d>(1,state.leftPose),
+		                     std::vector<Eigen::Isometry3d>(1,state.rightPose),
+		                     std::vector<double>(1,1.0));
 	}
 	else
 	{
@@ -454,7 +652,7 @@ bool iCubBase::release_object()
 bool iCubBase::move_object(const Eigen::Isometry3d &pose,
                            const double &time)
 {
-	if(not this->isGrasping)
+	if(not this->graspPlanned)
 	{
 		std::cerr << "[ERROR] [ICUB BASE] move_object(): "
 		          << "I am not grasping anything!\n";
@@ -474,11 +672,36 @@ bool iCubBase::move_object(const Eigen::Isometry3d &pose,
 		std::vector<Eigen::Isometry3d> poses;
 		poses.push_back(pose);
 		
-		std::vector<double> times;
-		times.push_back(time);
-		
-		return move_object(poses,times);                                                    // Pass onward for spline generation
-	}
+		if(not this->reachability.is_empty())
+		{
+			// The hands keep their place on the object, so move the object to keep both in reach
+			PlanningState state = latest_state();
+			
+			Eigen::Isometry3d leftTarget  = pose*state.payload.pose().inverse()*state.leftPose;
+			Eigen::Isometry3d rightTarget = pose*state.payload.pose().inverse()*state.rightPose;
+			
+			Eigen::Vector3d leftShift, rightShift;
+			
+			if(not check_reach(ReachabilityMap::left,  leftTarget.translation(), leftShift)
+			or not check_reach(ReachabilityMap::right, rightTarget.translation() + leftShift, rightShift)) return false;
+			
+			if(rightShift.norm() > 0
+			and this->reachability.score(ReachabilityMap::left, leftTarget.translation() + leftShift + rightShift) <= 0)
+			{
+				std::cerr << "[ERROR] [ICUB BASE] move_object(): "
+				          << "Could not find an object pose near the target that both hands can reach.\n";
+				
+				return false;
+			}
+			
+			poses[0].translation() += leftShift + rightShift;
+		}
+		
+		std::vector<double> times;
+		times.push_back(time);
+		
+		return move_object(poses,times);                                                    // Pass onward for spline generation
+	}
 }
 
   ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -487,28 +710,94 @@ bool iCubBase::move_object(const Eigen::Isometry3d &pose,
 bool iCubBase::move_object(const std::vector<Eigen::Isometry3d> &poses,
                            const std::vector<double> &times)
 {
-	if( isRunning() ) stop();                                                                   // Stop any control threads that are running
+	if(not this->graspPlanned)
+	{
+		std::cerr << "[ERROR] [ICUB BASE] move_object(): "
+		          << "I am not grasping anything!\n";
+		
+		return false;
+	}
 	
-	this->controlSpace = cartesian;                                                             // Ensure that we are running in Cartesian mode
+	PlanningState state = latest_state();
 	
-	// Set up the times for the trajectory
-	std::vector<double> t; t.push_back(0);                                                      // Start immediately
-	t.insert(t.end(),times.begin(),times.end());                                                // Add on the rest of the times
+	return plan_object_motion(state.payload, this->plannedGraspWidth, poses, times);
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                     Move the grasped object along a compiled trajectory                        //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::move_object(const MultiSpline &compiled)
+{
+	if(not this->graspPlanned)
+	{
+		std::cerr << "[ERROR] [ICUB BASE] move_object(): "
+		          << "I am not grasping anything!\n";
+		
+		return false;
+	}
 	
-	// Set up the waypoints for the object
-	std::vector<Eigen::Isometry3d> waypoints; waypoints.push_back( this->payload.pose() );      // First waypoint is current pose
-	waypoints.insert( waypoints.end(), poses.begin(), poses.end() );                            // Add on additional waypoints to the end
+	PlanningState state = latest_state();
 	
+	return plan_object_motion(state.payload, this->plannedGraspWidth, compiled);
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                   Make a plan to move a grasped object, starting from its current state        //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::plan_object_motion(const Payload                        &object,
+                                  const double                         &width,
+                                  const std::vector<Eigen::Isometry3d> &poses,
+                                  const std::vector<double>            &times)
+{
 	try
 	{
+		return plan_object_motion(object, width, CartesianTrajectory::compile(poses, times));
+	}
+	catch(std::exception &exception)
+	{
+		std::cerr << "[ERROR] [ICUB BASE] move_object(): "
+		          << "Could not assign a new trajectory for the object.\n";
+		          
+		std::cout << exception.what() << std::endl;
+		
+		return false;       
+	}
+}
 
-		this->payloadTrajectory = CartesianTrajectory(waypoints, t,this->payload.twist());  // Create new trajectory to follow
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //               Make a plan to move a grasped object along a compiled trajectory                 //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::plan_object_motion(const Payload     &object,
+                                  const double      &width,
+                                  const MultiSpline &compiled)
+{
+	ControlPlan newPlan;
+	newPlan.controlSpace = cartesian;                                                           // Ensure that we are running in Cartesian mode
+	newPlan.isGrasping   = true;                                                                // Activate the grasp constraints
+	newPlan.payload      = object;
+	newPlan.graspWidth   = width;
+	newPlan.startTime    = plan_time();                                                         // On the control loop's clock
+	
+	Eigen::Isometry3d start = object.pose();
+	Eigen::Matrix<double,6,1> vel = object.twist();
+	Eigen::Matrix<double,6,1> acc = Eigen::Matrix<double,6,1>::Zero();                          // Carried over when blending
+	
+	{
+		std::lock_guard<std::mutex> lock(this->planMutex);
 		
-		this->endTime = times.back();                                                       // Assign the end time
+		if(can_blend(true, newPlan.startTime))                                              // Already moving the object
+		{
+			this->lastPlan.payloadTrajectory.get_state(start, vel, acc, newPlan.startTime - this->lastPlan.startTime);
+		}
+	}
+	
+	try
+	{
+		newPlan.payloadTrajectory = CartesianTrajectory(compiled, start, vel, acc);         // Create new trajectory to follow
 		
-		start();                                                                            // go immediately to threadInit()
+		newPlan.endTime = compiled.end_time();                                              // Assign the end time
 		
-		return true;
+		return publish_plan(newPlan);                                                       // Takes effect on the next control step
 	}
 	catch(std::exception &exception)
 	{
@@ -521,6 +810,169 @@ bool iCubBase::move_object(const std::vector<Eigen::Isometry3d> &poses,
 	}
 }
 
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                   Get the most recent state of the robot to start a new plan from              //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+iCubBase::PlanningState iCubBase::latest_state()
+{
+	std::lock_guard<std::mutex> lock(this->planMutex);
+	
+	if(not isRunning()) update_state();                                                         // Nobody else is updating it
+	
+	this->states.update();
+	
+	return this->states.read_buffer();
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //             Hand a new plan to the control thread, which picks it up on the next step          //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::publish_plan(ControlPlan &newPlan)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->preflightMutex);                             // Only one plan rehearsed at a time
+		
+		if(this->preflight and not check_plan(newPlan)) return false;                       // The robot is left alone
+	}
+	
+	{
+		std::lock_guard<std::mutex> lock(this->planMutex);
+		
+		newPlan.id = this->plannedId + 1;
+		
+		this->graspPlanned = newPlan.isGrasping;
+		
+		if(newPlan.isGrasping) this->plannedGraspWidth = newPlan.graspWidth;
+		
+		this->plans.write_buffer() = newPlan;                                               // Copy here, not in the control thread
+		
+		this->lastPlan = newPlan;                                                           // So the next plan can blend from it
+		
+		this->plans.publish();
+		
+		this->plannedId = newPlan.id;                                                       // Now is_finished() is false
+		
+		if(not isRunning()) start();                                                        // Only needed the first time, or after halt()
+	}
+	
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                 Rehearse a plan on the copy of the kinematics before it is published           //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::check_plan(const ControlPlan &newPlan)
+{
+	std::string diagnosis;
+	
+	if(newPlan.controlSpace == joint)
+	{
+		if(this->preflight->check_joint_motion(newPlan.jointTrajectory, this->dt, diagnosis)) return true;
+	}
+	else if(newPlan.controlSpace == cartesian and not newPlan.isGrasping)
+	{
+		Eigen::Matrix<double,6,6> gain;
+		double manipulability;
+		
+		{
+			std::lock_guard<std::mutex> lock(this->gainMutex);
+			
+			gain           = this->gains.K;
+			manipulability = this->gains.threshold;
+		}
+		
+		if(this->preflight->check_cartesian_motion(latest_state().q,
+		                                           newPlan.leftTrajectory,
+		                                           newPlan.rightTrajectory,
+		                                           newPlan.endTime,
+		                                           this->desiredPosition,
+		                                           gain,
+		                                           manipulability,
+		                                           this->dt,
+		                                           diagnosis)) return true;
+	}
+	else return true;                                                                           // Grasping & streaming aren't checked
+	
+	std::cerr << "[ERROR] [ICUB BASE] check_plan(): "
+	          << "The action was not started because the pre-flight check failed. " << diagnosis << "\n";
+	
+	return false;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                  Switch to the newest plan, if there is one (control thread only)              //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::adopt_new_plan()
+{
+	if(not this->plans.update()) return false;                                                  // Keep doing the same thing
+	
+	const ControlPlan &newPlan = this->plans.read_buffer();
+	
+	if(newPlan.isGrasping and not this->isGrasping)                                             // Just grasped something
+	{
+		this->payload    = newPlan.payload;
+		this->graspWidth = newPlan.graspWidth;
+	}
+	
+	this->isGrasping = newPlan.isGrasping;
+	
+	if(newPlan.controlSpace == streaming) this->setpoints.discard_before(newPlan.startTime);     // Ignore anything sent before the request
+	
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //              Hand the latest gains to the control thread, which picks them up next step        //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void iCubBase::publish_gains()
+{
+	this->gainBuffer.write_buffer() = this->gains;                                              // Copy here, not in the control thread
+	
+	this->gainBuffer.publish();
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                     Use the latest gains, if any have been set since the last step             //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void iCubBase::adopt_new_gains()
+{
+	if(not this->gainBuffer.update()) return;                                                   // Nothing has changed
+	
+	const ControlGains &newGains = this->gainBuffer.read_buffer();                              // Fixed size, so copying doesn't allocate
+	
+	this->K                = newGains.K;
+	this->D                = newGains.D;
+	this->kp               = newGains.kp;
+	this->kd               = newGains.kd;
+	this->maxDamping       = newGains.maxDamping;
+	this->threshold        = newGains.threshold;
+	this->actuationLatency = newGains.actuationLatency;
+	this->maxPrediction    = newGains.maxPrediction;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //           Time the control loop evaluates plans at, which is ahead by the actuation latency    //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+double iCubBase::plan_time()
+{
+	std::lock_guard<std::mutex> lock(this->gainMutex);
+	
+	return yarp::os::Time::now() + this->gains.actuationLatency;                                // Same as stateTime in update_state()
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //       Check if a new plan can start from the reference of the previous one (hold planMutex)    //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::can_blend(const bool &grasping, const double &switchTime)
+{
+	if(not this->blendTrajectories
+	or not isRunning()                                                                          // Stopped by halt()
+	or this->lastPlan.controlSpace != cartesian
+	or this->lastPlan.isGrasping   != grasping) return false;                                   // Different trajectories are being tracked
+	
+	return switchTime - this->lastPlan.startTime < this->lastPlan.endTime;                      // Still in the middle of it
+}
+
   ////////////////////////////////////////////////////////////////////////////////////////////////////
  //                         Get the error between a desired and actual pose                        //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -551,8 +1003,12 @@ bool iCubBase::set_cartesian_gains(const double &proportional, const double &der
 	}
 	else
 	{
-		this->K = proportional*this->gainTemplate;
-		this->D = derivative*this->gainTemplate;
+		std::lock_guard<std::mutex> lock(this->gainMutex);
+		
+		this->gains.K = proportional*this->gainTemplate;
+		this->gains.D = derivative*this->gainTemplate;
+		
+		publish_gains();                                                                    // Takes effect on the next control step
 
 		return true;
 	}
@@ -573,20 +1029,96 @@ bool iCubBase::set_joint_gains(const double &proportional, const double &derivat
 	}
 	else
 	{
-		this->kp = proportional;
-		this->kd = derivative;
+		std::lock_guard<std::mutex> lock(this->gainMutex);
+		
+		this->gains.kp = proportional;
+		this->gains.kd = derivative;
+		
+		publish_gains();
 		
 		return true;
 	}
 }
   
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                         Check a whole set of gains, before any are used                        //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::check_gains(const GainSettings &settings)
+{
+	bool valid = true;                                                                          // Report every problem, not just the first
+	
+	if(settings.cartesianProportional < 0 or settings.cartesianDerivative < 0)
+	{
+		std::cerr << "[ERROR] [ICUB BASE] check_gains(): "
+		          << "Cartesian gains must be positive, but they were " << settings.cartesianProportional
+		          << " and " << settings.cartesianDerivative << ".\n";
+		
+		valid = false;
+	}
+	
+	if(settings.jointProportional < 0 or settings.jointDerivative < 0)
+	{
+		std::cerr << "[ERROR] [ICUB BASE] check_gains(): "
+		          << "Joint gains must be positive, but they were " << settings.jointProportional
+		          << " and " << settings.jointDerivative << ".\n";
+		
+		valid = false;
+	}
+	
+	if(settings.maxDamping <= 0 or settings.threshold <= 0)
+	{
+		std::cerr << "[ERROR] [ICUB BASE] check_gains(): "
+		          << "Singularity avoidance parameters must be positive, but the damping was "
+		          << settings.maxDamping << ", and the threshold was " << settings.threshold << ".\n";
+		
+		valid = false;
+	}
+	
+	if(settings.actuationLatency < 0 or settings.maxPrediction < 0)
+	{
+		std::cerr << "[ERROR] [ICUB BASE] check_gains(): "
+		          << "Latency compensation must be non-negative, but the actuation latency was "
+		          << settings.actuationLatency << ", and the maximum horizon was " << settings.maxPrediction << ".\n";
+		
+		valid = false;
+	}
+	
+	return valid;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                 Set all the gains together, so the control thread never sees a mix             //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::set_gains(const GainSettings &settings)
+{
+	if(not check_gains(settings)) return false;                                                 // Nothing has been changed
+	
+	ControlGains newGains;
+	newGains.K                = settings.cartesianProportional*this->gainTemplate;
+	newGains.D                = settings.cartesianDerivative*this->gainTemplate;
+	newGains.kp               = settings.jointProportional;
+	newGains.kd               = settings.jointDerivative;
+	newGains.maxDamping       = settings.maxDamping;
+	newGains.threshold        = settings.threshold;
+	newGains.actuationLatency = settings.actuationLatency;
+	newGains.maxPrediction    = settings.maxPrediction;
+	
+	std::lock_guard<std::mutex> lock(this->gainMutex);
+	
+	this->gains = newGains;
+	
+	publish_gains();                                                                            // One hand-over for the whole set
+	
+	return true;
+}
+
   ///////////////////////////////////////////////////////////////////////////////////////////////////
  //                               Return the pose of a given hand                                 //
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 Eigen::Isometry3d iCubBase::hand_pose(const std::string &which)
 {
-	     if(which == "left")  return this->leftPose;
-	else if(which == "right") return this->rightPose;
+	     if(which == "left")  return latest_state().leftPose;
+	else if(which == "right") return latest_state().rightPose;
 	else throw std::invalid_argument("[ERROR] [iCUB BASE] hand_pose(): Expected 'left' or 'right' but the argument was '"+which+"'.");
 }
 
@@ -626,13 +1158,228 @@ bool iCubBase::set_singularity_avoidance_params(const double &_maxDamping, const
 	}
 	else
 	{
-		this->maxDamping = _maxDamping;
-		this->threshold = _threshold;
+		std::lock_guard<std::mutex> lock(this->gainMutex);
+		
+		this->gains.maxDamping = _maxDamping;
+		this->gains.threshold  = _threshold;
+		
+		publish_gains();
+		
+		return true;
+	}
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                                Set the rate of the control loop                                //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::set_control_frequency(const double &frequency)
+{
+	if(frequency < 1 or frequency > 1000)
+	{
+		std::cerr << "[ERROR] [iCUB BASE] set_control_frequency(): "
+		          << "Frequency must be between 1 and 1000 Hz, but the argument was "
+		          << frequency << ".\n";
+		
+		return false;
+	}
+	else if(not this->setPeriod(1.0/frequency))
+	{
+		std::cerr << "[ERROR] [iCUB BASE] set_control_frequency(): "
+		          << "Could not change the period of the control thread.\n";
+		
+		return false;
+	}
+	else
+	{
+		this->dt = 1.0/frequency;                                                           // Feedforward terms use this
+		
+		std::cout << "[INFO] [iCUB BASE] Control frequency set to " << frequency << " Hz.\n";
+		
+		return true;
+	}
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                       Set the scheduling options for the control thread                        //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::set_real_time_options(const RealTimeOptions &options)
+{
+	if(options.lockMemory and not this->realTimeOptions.lockMemory)
+	{
+		if(not lock_process_memory()) return false;                                        // Only needs doing once for the process
+	}
+	
+	this->realTimeOptions = options;                                                            // Used next time the thread starts
+	
+	return true;
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //             Warn if the computation time is too large for the control frequency               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void iCubBase::check_timing()
+{
+	if(this->overrunWarned or getIterations() < 1.0/this->dt) return;                       // Wait 1 second for stats to settle
+	
+	double used = getEstimatedUsed();                                                           // Average time spent in run()
+	
+	if(used > this->maxLoad*this->dt)
+	{
+		std::cerr << "[WARNING] [iCUB BASE] check_timing(): "
+		          << "Each control step takes " << used*1000 << " ms on average, but the period is only "
+		          << this->dt*1000 << " ms. Consider lowering the control frequency.\n";
+		
+		this->overrunWarned = true;
+	}
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //                  Set how far ahead the joint state is predicted to cover latency               //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::set_latency_compensation(const double &actuation, const double &maxHorizon)
+{
+	if(actuation < 0 or maxHorizon < 0)
+	{
+		std::cerr << "[ERROR] [iCUB BASE] set_latency_compensation(): "
+		          << "Arguments must be non-negative, but the actuation latency was "
+		          << actuation << ", and the maximum horizon was " << maxHorizon << ".\n";
+		
+		return false;
+	}
+	else
+	{
+		std::lock_guard<std::mutex> lock(this->gainMutex);
+		
+		this->gains.actuationLatency = actuation;
+		this->gains.maxPrediction    = maxHorizon;
+		
+		publish_gains();
+		
+		return true;
+	}
+}
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////////
+ //              Time joint motions by the velocity & acceleration limits of the motors           //
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::set_trajectory_retiming(const bool &active, const double &limitScale)
+{
+	if(limitScale <= 0 or limitScale > 1)
+	{
+		std::cerr << "[ERROR] [iCUB BASE] set_trajectory_retiming(): "
+		          << "Scale on the limits must be between 0 and 1, but it was " << limitScale << ".\n";
+		
+		return false;
+	}
+	else
+	{
+		this->retimingScale      = limitScale;                                              // Scale first, so a new flag never sees the old one
+		this->retimeTrajectories = active;
 		
 		return true;
 	}
 }
 
+  ///////////////////////////////////////////////////////////////////////////////////////////////////
+ //                 Load a map of where the hands can reach, to check targets against             //
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::set_reachability_map(const std::string &path, const double &_maxAdjustment)
+{
+	if(_maxAdjustment < 0)
+	{
+		std::cerr << "[ERROR] [ICUB BASE] set_reachability_map(): "
+		          << "Maximum adjustment must be positive, but it was " << _maxAdjustment << ".\n";
+		
+		return false;
+	}
+	
+	ReachabilityMap map;
+	
+	if(not map.load(path)) return false;
+	
+	this->reachability  = std::move(map);
+	this->maxAdjustment = _maxAdjustment;
+	
+	return true;
+}
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////////
+ //          Check a hand can reach a target, and how far to move it if it can't                  //
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::check_reach(const ReachabilityMap::Hand &hand,
+                           const Eigen::Vector3d       &target,
+                           Eigen::Vector3d             &shift)
+{
+	shift.setZero();
+	
+	if(this->reachability.is_empty() or this->reachability.score(hand, target) > 0) return true; // Nothing to check, or it's fine
+	
+	std::string name = hand == ReachabilityMap::left ? "left" : "right";
+	
+	Eigen::Vector3d nearest;
+	
+	if(this->maxAdjustment > 0 and this->reachability.nearest_reachable(hand, target, this->maxAdjustment, nearest))
+	{
+		shift = nearest - target;
+		
+		std::cout << "[WARNING] [ICUB BASE] check_reach(): "
+		          << "Moved the " << name << " hand target " << shift.norm() << " m so that it can be reached.\n";
+		
+		return true;
+	}
+	
+	std::cerr << "[ERROR] [ICUB BASE] check_reach(): "
+	          << "The " << name << " hand can't reach (" << target.transpose() << ").\n";
+	
+	return false;
+}
+
+  ///////////////////////////////////////////////////////////////////////////////////////////////////
+ //                    Rehearse every joint & Cartesian action before running it                  //
+///////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::enable_preflight(const bool &active)
+{
+	return create_preflight(active, Eigen::MatrixXd(), Eigen::VectorXd());                      // No joint constraints by default
+}
+
+  ////////////////////////////////////////////////////////////////////////////////////////////////////
+ //            Make the pre-flight check & give it its constraints before any plan can use it      //
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool iCubBase::create_preflight(const bool            &active,
+                                const Eigen::MatrixXd &A,
+                                const Eigen::VectorXd &b)
+{
+	std::lock_guard<std::mutex> lock(this->preflightMutex);
+	
+	if(not active)
+	{
+		this->preflight.reset();
+		
+		return true;
+	}
+	
+	try
+	{
+		this->preflight.reset(new PreFlight(this->computer.model(),                         // Copy of the model, with the hand frames
+		                                    this->basePose,
+		                                    this->positionLimit,
+		                                    this->velocityLimit));
+		
+		if(A.rows() > 0) this->preflight->set_constraints(A, b);                            // Before check_plan() can see it
+		
+		return true;
+	}
+	catch(const std::exception &exception)
+	{
+		std::cerr << "[ERROR] [ICUB BASE] enable_preflight(): "
+		          << "Could not create the pre-flight check.\n";
+		
+		std::cout << exception.what() << std::endl;
+		
+		return false;
+	}
+}
+
   ///////////////////////////////////////////////////////////////////////////////////////////////////
  //                Decompose a rotation matrix in to its angle*axis representation                //
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -642,7 +1389,7 @@ Eigen::Vector3d iCubBase::angle_axis(const Eigen::Matrix3d &R)
 	
 	double angle = acos((trace-1)/2);
 	
-	if(abs(angle) < 1e-05) return Eigen::Vector3d::Zero();                                      
+	if(std::abs(angle) < 1e-05) return Eigen::Vector3d::Zero();                                 // Not ::abs(int)
 	else
 	{
 		if(angle > M_PI) angle = 2*M_PI - angle;                                            // Ensure angle is within [-3.14159, 3.14159]
@@ -55,7 +55,7 @@ tmux split-window -v -t $TMUX_NAME
 tmux send-keys -t $TMUX_NAME "docker exec -it $DOCKER_CONTAINER_NAME bash" Enter
 tmux send-keys -t $TMUX_NAME "cd /root/ergocub-manipulation/build/bin" Enter
 tmux send-keys -t $TMUX_NAME "sleep 10" Enter
-tmux send-keys -t $TMUX_NAME "./ergocub_grasp_demo /ergocubSim /robotology-superbuild/build/install/share/ergoCub/robots/ergoCubGazeboV1/model.urdf" Enter
+tmux send-keys -t $TMUX_NAME "./command_server /Components/Manipulation /ergocubSim /robotology-superbuild/build/install/share/ergoCub/robots/ergoCubGazeboV1/model.urdf /root/ergocub-manipulation/config/ergocub.ini" Enter
 tmux select-pane -t $TMUX_NAME:0.2
 tmux split-window -v -t $TMUX_NAME
 